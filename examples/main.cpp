@@ -13,6 +13,10 @@ void test3DOneshotSound();
 void testVrPlayerPositionAndSound();
 void testVrRoomEffects();
 void testVrObject();
+void testRenderNrt();
+void testMusicLayers();
+void testBgmPlaylist();
+void testQuantizedCrossfade();
 
 void displayMenu() {
     std::cout << "\n================================\n";
@@ -28,6 +32,10 @@ void displayMenu() {
     std::cout << "8: Test VR Player Position & Sound\n";
     std::cout << "9: Test VR Room Effects\n";
     std::cout << "10: Test VR Object\n";
+    std::cout << "11: Test Headless Render (NRT)\n";
+    std::cout << "12: Test Music Layers\n";
+    std::cout << "13: Test BGM Playlist\n";
+    std::cout << "14: Test Quantized Crossfade\n";
     std::cout << "0: Quit\n";
     std::cout << "================================\n";
     std::cout << "Select an option: ";
@@ -100,6 +108,22 @@ int main() {
                 testVrObject();
                 break;
 
+            case 11:
+                testRenderNrt();
+                break;
+
+            case 12:
+                testMusicLayers();
+                break;
+
+            case 13:
+                testBgmPlaylist();
+                break;
+
+            case 14:
+                testQuantizedCrossfade();
+                break;
+
             default:
                 std::cout << "Invalid option. Please try again.\n";
                 break;
@@ -33,7 +33,7 @@ void testBGMFunctions() {
         audio_coreFree();
         return;
     }
-    std::cout << "SUCCESS: BGM 1 loaded to slot " << slot1 << "\n";
+    std::cout << "SUCCESS: BGM 1 loaded (handle " << slot1 << ")\n";
 
     std::cout << "Loading BGM 2...\n";
     int slot2 = audio_bgmLoad(bgm2_data.data(), static_cast<int>(bgm2_data.size()));
@@ -43,7 +43,7 @@ void testBGMFunctions() {
         audio_coreFree();
         return;
     }
-    std::cout << "SUCCESS: BGM 2 loaded to slot " << slot2 << "\n";
+    std::cout << "SUCCESS: BGM 2 loaded (handle " << slot2 << ")\n";
 
     // Helper lambda for error checking
     auto checkError = [&](int result, const char* operation) -> bool {
@@ -104,6 +104,23 @@ void testBGMFunctions() {
     if (!checkError(audio_bgmFree(slot2), "audio_bgmFree(slot2)")) return;
     std::cout << "BGM slots freed\n";
 
+    // The slot is reused with a new generation, so the freed handle must not reach the new track
+    std::cout << "\nReloading BGM 1 into the freed slot...\n";
+    int reloaded = audio_bgmLoad(bgm1_data.data(), static_cast<int>(bgm1_data.size()));
+    if (reloaded < 0) {
+        std::cout << "FAILURE: Failed to reload BGM 1\n";
+        audio_coreFree();
+        return;
+    }
+    if (audio_bgmPlay(slot1) == 0) {
+        std::cout << "FAILURE: Freed handle " << slot1 << " still plays handle " << reloaded << "\n";
+    } else {
+        char errorBuffer[512];
+        audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+        std::cout << "SUCCESS: Freed handle rejected (" << errorBuffer << ")\n";
+    }
+    audio_bgmFree(reloaded);
+
     // Free audio backend
     std::cout << "\n";
     freeAudioBackend();
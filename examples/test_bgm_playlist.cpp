@@ -0,0 +1,76 @@
+#include <iostream>
+#include "helper.h"
+#include "../src/audio_backend.h"
+
+// Wait until an audio_bgmOpenStream stream has opened, false on failure or timeout
+static bool waitStreamOpen(int slot) {
+    BgmStreamState state = {};
+    for (int i = 0; i < 200; i++) {
+        if (audio_bgmGetStreamState(slot, &state) != 0 || state.open_state == 2) {  // FMOD_OPENSTATE_ERROR
+            return false;
+        }
+        if (state.open_state != 1) {  // FMOD_OPENSTATE_LOADING
+            return true;
+        }
+        waitMilliseconds(10);
+    }
+    return false;
+}
+
+void testBgmPlaylist() {
+    std::cout << "\n--- Testing BGM Playlist ---\n";
+
+    if (!initAudioBackend()) return;
+
+    // "Intro" is the first 4 seconds of the hats stem, then the full mix loops
+    std::cout << "Opening streams (assets\\bgm_hats.ogg, assets\\bgm_full.ogg)...\n";
+    int intro = audio_bgmOpenStream("assets\\bgm_hats.ogg");
+    int loop = audio_bgmOpenStream("assets\\bgm_full.ogg");
+    int playlist = -1;
+
+    // Helper lambda for error checking
+    auto checkError = [&](int result, const char* operation) -> bool {
+        if (result == -1) {
+            char errorBuffer[512];
+            audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+            std::cout << "ERROR in " << operation << ": " << errorBuffer << "\n";
+            audio_bgmPlaylistFree(playlist);
+            audio_bgmFree(intro);
+            audio_bgmFree(loop);
+            audio_coreFree();
+            return false;
+        }
+        return true;
+    };
+    if (!checkError(intro < 0 || loop < 0 ? -1 : 0, "audio_bgmOpenStream")) return;
+    if (!checkError(waitStreamOpen(intro) && waitStreamOpen(loop) ? 0 : -1, "audio_bgmGetStreamState")) return;
+
+    playlist = audio_bgmPlaylistCreate();
+    if (!checkError(playlist < 0 ? -1 : 0, "audio_bgmPlaylistCreate")) return;
+    if (!checkError(audio_bgmPlaylistAppend(playlist, intro, 4000), "audio_bgmPlaylistAppend(intro)")) return;
+    if (!checkError(audio_bgmPlaylistAppend(playlist, loop, -1), "audio_bgmPlaylistAppend(loop)")) return;
+    std::cout << "SUCCESS: Playlist created (intro up to 4000ms, then the loop)\n";
+
+    std::cout << "\nPlaying... the loop takes over with no gap after 4 seconds\n";
+    if (!checkError(audio_bgmPlaylistPlay(playlist), "audio_bgmPlaylistPlay")) return;
+    int last_segment = -2;
+    for (int i = 0; i < 80; i++) {
+        int segment = -1;
+        if (!checkError(audio_bgmPlaylistGetSegment(playlist, &segment), "audio_bgmPlaylistGetSegment")) return;
+        if (segment != last_segment) {
+            std::cout << "Segment " << segment << " (" << i * 100 << "ms)\n";
+            last_segment = segment;
+        }
+        waitMilliseconds(100);
+    }
+
+    std::cout << "\nStopping the playlist...\n";
+    if (!checkError(audio_bgmPlaylistStop(playlist), "audio_bgmPlaylistStop")) return;
+    if (!checkError(audio_bgmPlaylistFree(playlist), "audio_bgmPlaylistFree")) return;
+    audio_bgmFree(intro);
+    audio_bgmFree(loop);
+
+    freeAudioBackend();
+
+    std::cout << "\n--- BGM Playlist Test Completed ---\n";
+}
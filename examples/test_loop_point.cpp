@@ -1,5 +1,4 @@
 #include <iostream>
-#include <vector>
 #include "helper.h"
 #include "../src/audio_backend.h"
 
@@ -8,23 +7,19 @@ void testLoopPoint() {
 
     if (!initAudioBackend()) return;
 
-    // Load BGM file from assets
-    std::cout << "Loading BGM (assets\\cat_music.ogg)...\n";
-    std::vector<char> bgm_data = loadFile("assets\\cat_music.ogg");
-    if (bgm_data.empty()) {
-        std::cout << "FAILURE: Failed to load cat_music.ogg\n";
-        audio_coreFree();
-        return;
-    }
-
-    // Load BGM to slot
-    int slot = audio_bgmLoad(bgm_data.data(), static_cast<int>(bgm_data.size()));
+    // Stream the BGM from disk with a 32 KB file buffer and 500 ms decoded ahead
+    std::cout << "Opening BGM (assets\\cat_music.ogg) as a disk stream...\n";
+    audio_bgmSetStreamBufferSize(32 * 1024, 500);
+    int slot = audio_bgmOpenStream("assets\\cat_music.ogg");
     if (slot < 0) {
         std::cout << "FAILURE: Failed to load BGM\n";
+        char errorBuffer[512];
+        audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+        std::cout << "Error: " << errorBuffer << "\n";
         audio_coreFree();
         return;
     }
-    std::cout << "SUCCESS: BGM loaded to slot " << slot << "\n";
+    std::cout << "SUCCESS: BGM loaded (handle " << slot << ")\n";
 
     // Helper lambda for error checking
     auto checkError = [&](int result, const char* operation) -> bool {
@@ -39,6 +34,17 @@ void testLoopPoint() {
         return true;
     };
 
+    // The stream opens in the background, wait until it can be played
+    BgmStreamState state = {};
+    for (int i = 0; i < 200; i++) {
+        if (!checkError(audio_bgmGetStreamState(slot, &state), "audio_bgmGetStreamState")) return;
+        if (state.open_state != 1) {  // FMOD_OPENSTATE_LOADING
+            break;
+        }
+        waitMilliseconds(10);
+    }
+    std::cout << "Stream state: open_state " << state.open_state << ", buffered " << state.percent_buffered << "%\n";
+
     // Set volume to 0.4 (cat song is loud)
     std::cout << "Setting BGM volume to 0.4...\n";
     if (!checkError(audio_globalSetBgmVolume(0.4f), "audio_globalSetBgmVolume")) return;
@@ -57,6 +63,9 @@ void testLoopPoint() {
     // Wait for Enter key
     std::cin.get();
 
+    if (!checkError(audio_bgmGetStreamState(slot, &state), "audio_bgmGetStreamState")) return;
+    std::cout << "Stream starved " << state.starve_count << " time(s)\n";
+
     // Fadeout
     std::cout << "Fading out...\n";
     if (!checkError(audio_bgmFadeout(slot, 1500), "audio_bgmFadeout")) return;
@@ -0,0 +1,82 @@
+#include <iostream>
+#include "helper.h"
+#include "../src/audio_backend.h"
+
+void testMusicLayers() {
+    std::cout << "\n--- Testing Music Layers ---\n";
+
+    if (!initAudioBackend()) return;
+
+    // The three stems of one piece, each a memory-mapped stream
+    const char* paths[] = { "assets\\bgm_full.ogg", "assets\\bgm_hats.ogg", "assets\\bgm_toms.ogg" };
+    int slots[3] = { -1, -1, -1 };
+    for (int i = 0; i < 3; i++) {
+        std::cout << "Loading layer " << i << " (" << paths[i] << ")...\n";
+        slots[i] = audio_bgmLoadFile(paths[i]);
+        if (slots[i] < 0) {
+            char errorBuffer[512];
+            audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+            std::cout << "FAILURE: Failed to load " << paths[i] << ": " << errorBuffer << "\n";
+            for (int j = 0; j < i; j++) {
+                audio_bgmFree(slots[j]);
+            }
+            audio_coreFree();
+            return;
+        }
+    }
+
+    int group = audio_musicGroupCreate(slots, 3);
+
+    // Helper lambda for error checking
+    auto checkError = [&](int result, const char* operation) -> bool {
+        if (result == -1) {
+            char errorBuffer[512];
+            audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+            std::cout << "ERROR in " << operation << ": " << errorBuffer << "\n";
+            audio_musicGroupFree(group);
+            for (int i = 0; i < 3; i++) {
+                audio_bgmFree(slots[i]);
+            }
+            audio_coreFree();
+            return false;
+        }
+        return true;
+    };
+    if (!checkError(group < 0 ? -1 : 0, "audio_musicGroupCreate")) return;
+    std::cout << "SUCCESS: Music group created (handle " << group << ")\n";
+
+    // Start with only the full mix audible, the other layers play silently in phase
+    if (!checkError(audio_musicGroupSetLayerVolume(group, 1, 0.0f, 0), "audio_musicGroupSetLayerVolume")) return;
+    if (!checkError(audio_musicGroupSetLayerVolume(group, 2, 0.0f, 0), "audio_musicGroupSetLayerVolume")) return;
+
+    std::cout << "\nStarting all layers on one DSP clock...\n";
+    if (!checkError(audio_musicGroupPlay(group), "audio_musicGroupPlay")) return;
+    std::cout << "Full mix only... (wait 4 seconds)\n";
+    waitSeconds(4);
+
+    std::cout << "\nRaising intensity: hats in over 1000ms...\n";
+    if (!checkError(audio_musicGroupSetLayerVolume(group, 1, 1.0f, 1000), "audio_musicGroupSetLayerVolume")) return;
+    waitSeconds(4);
+
+    std::cout << "Raising intensity: toms in over 1000ms...\n";
+    if (!checkError(audio_musicGroupSetLayerVolume(group, 2, 1.0f, 1000), "audio_musicGroupSetLayerVolume")) return;
+    waitSeconds(4);
+
+    std::cout << "\nCalming down: hats and toms out over 2000ms...\n";
+    if (!checkError(audio_musicGroupSetLayerVolume(group, 1, 0.0f, 2000), "audio_musicGroupSetLayerVolume")) return;
+    if (!checkError(audio_musicGroupSetLayerVolume(group, 2, 0.0f, 2000), "audio_musicGroupSetLayerVolume")) return;
+    waitSeconds(3);
+
+    std::cout << "\nStopping the group...\n";
+    if (!checkError(audio_musicGroupStop(group), "audio_musicGroupStop")) return;
+
+    // Freeing the group keeps the slots, they are freed separately
+    if (!checkError(audio_musicGroupFree(group), "audio_musicGroupFree")) return;
+    for (int i = 0; i < 3; i++) {
+        audio_bgmFree(slots[i]);
+    }
+
+    freeAudioBackend();
+
+    std::cout << "\n--- Music Layers Test Completed ---\n";
+}
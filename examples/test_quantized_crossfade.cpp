@@ -0,0 +1,67 @@
+#include <iostream>
+#include "helper.h"
+#include "../src/audio_backend.h"
+
+void testQuantizedCrossfade() {
+    std::cout << "\n--- Testing Quantized Crossfade ---\n";
+
+    if (!initAudioBackend()) return;
+
+    std::cout << "Loading BGM (assets\\bgm_full.ogg, assets\\bgm_toms.ogg)...\n";
+    int full = audio_bgmLoadFile("assets\\bgm_full.ogg");
+    int toms = audio_bgmLoadFile("assets\\bgm_toms.ogg");
+
+    // Helper lambda for error checking
+    auto checkError = [&](int result, const char* operation) -> bool {
+        if (result == -1) {
+            char errorBuffer[512];
+            audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+            std::cout << "ERROR in " << operation << ": " << errorBuffer << "\n";
+            audio_bgmFree(full);
+            audio_bgmFree(toms);
+            audio_coreFree();
+            return false;
+        }
+        return true;
+    };
+    if (!checkError(full < 0 || toms < 0 ? -1 : 0, "audio_bgmLoadFile")) return;
+
+    // Both stems are 120 BPM in 4/4 with the first downbeat at the very start
+    if (!checkError(audio_bgmSetTempo(full, 120.0f, 4, 0), "audio_bgmSetTempo(full)")) return;
+    if (!checkError(audio_bgmSetTempo(toms, 120.0f, 4, 0), "audio_bgmSetTempo(toms)")) return;
+    // A marker for the transition back, 6 seconds into the toms stem
+    if (!checkError(audio_bgmAddMarker(toms, 6000), "audio_bgmAddMarker")) return;
+
+    std::cout << "\nPlaying the full mix... (wait 3 seconds)\n";
+    if (!checkError(audio_bgmPlay(full), "audio_bgmPlay")) return;
+    waitSeconds(3);
+
+    unsigned long long now = 0;
+    unsigned long long bar = 0;
+    int rate = 0;
+    if (!checkError(audio_coreGetDSPClock(&now, &rate), "audio_coreGetDSPClock")) return;
+    if (!checkError(audio_bgmGetQuantizedClock(full, AUDIO_BGM_QUANTIZE_BAR, &bar), "audio_bgmGetQuantizedClock")) return;
+    std::cout << "Next bar in " << (bar - now) * 1000 / rate << "ms\n";
+
+    std::cout << "\nCrossfading to the toms on the next bar over 1000ms...\n";
+    if (!checkError(audio_bgmCrossfadeQuantized(full, toms, 1000, AUDIO_BGM_QUANTIZE_BAR), "audio_bgmCrossfadeQuantized(bar)")) return;
+    waitSeconds(4);
+
+    std::cout << "\nCrossfading back on the toms' marker (6000ms) over 500ms...\n";
+    if (!checkError(audio_bgmCrossfadeQuantized(toms, full, 500, AUDIO_BGM_QUANTIZE_MARKER), "audio_bgmCrossfadeQuantized(marker)")) return;
+    waitSeconds(5);
+
+    std::cout << "\nSwitching on the next beat without a fade...\n";
+    if (!checkError(audio_bgmCrossfadeQuantized(full, toms, 0, AUDIO_BGM_QUANTIZE_BEAT), "audio_bgmCrossfadeQuantized(beat)")) return;
+    waitSeconds(3);
+
+    std::cout << "\nStopping BGM...\n";
+    audio_bgmStop(full);
+    audio_bgmStop(toms);
+    audio_bgmFree(full);
+    audio_bgmFree(toms);
+
+    freeAudioBackend();
+
+    std::cout << "\n--- Quantized Crossfade Test Completed ---\n";
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include "helper.h"
+#include "../src/audio_backend.h"
+
+void testRenderNrt() {
+    std::cout << "\n--- Testing Headless Render (NRT) ---\n";
+
+    // Initialize without a sound card, the mixer only moves when we render
+    AudioCoreConfig config = {};
+    config.output_type = AUDIO_OUTPUT_NOSOUND_NRT;
+    config.sample_rate = 48000;
+    std::cout << "Initializing audio backend with NOSOUND_NRT output...\n";
+    if (audio_coreInitializeEx(&config) != 0) {
+        std::cout << "FAILURE: Audio backend failed to initialize\n";
+        char errorBuffer[512];
+        audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
+        std::cout << "Error: " << errorBuffer << "\n";
+        return;
+    }
+
+    int sample_rate = 0;
+    int channels = 0;
+    audio_coreGetRenderFormat(&sample_rate, &channels);
+    std::cout << "Render format: " << sample_rate << "Hz, " << channels << " channels\n";
+
+    std::vector<char> sample_data = loadFile("assets\\ding.ogg");
+    if (sample_data.empty() || audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "ding") < 0) {
+        std::cout << "FAILURE: Failed to load ding.ogg\n";
+        freeAudioBackend();
+        return;
+    }
+
+    // Silence before anything plays
+    std::vector<float> buffer(static_cast<size_t>(sample_rate) * channels);
+    audio_coreRenderFrames(1000, buffer.data(), static_cast<int>(buffer.size()));
+    float peak = 0.0f;
+    for (int i = 0; i < 1000 * channels; i++) {
+        peak = std::fmax(peak, std::fabs(buffer[i]));
+    }
+    std::cout << "Peak before playback: " << peak << (peak == 0.0f ? " (SUCCESS)\n" : " (FAILURE)\n");
+
+    // Render one second of the oneshot, much faster than realtime
+    SoundAttributes attr = {0.0f, 1.0f, 1.0f};
+    audio_sampleOneshot("ding", &attr);
+    auto start = std::chrono::steady_clock::now();
+    int rendered = audio_coreRenderFrames(sample_rate, buffer.data(), static_cast<int>(buffer.size()));
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    peak = 0.0f;
+    for (float v : buffer) {
+        peak = std::fmax(peak, std::fabs(v));
+    }
+    std::cout << "Rendered " << rendered << " frames in " << elapsed << "ms\n";
+    std::cout << "Peak during playback: " << peak << (peak > 0.0f ? " (SUCCESS)\n" : " (FAILURE)\n");
+
+    freeAudioBackend();
+
+    std::cout << "\n--- Headless Render Test Completed ---\n";
+}
@@ -19,8 +19,8 @@ void testSampleOneshot() {
 
     // Load sample with key
     std::cout << "Registering sample with key 'ding'...\n";
-    int result = audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "ding");
-    if (result != 0) {
+    int handle = audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "ding");
+    if (handle < 0) {
         std::cout << "FAILURE: Failed to load sample\n";
         char errorBuffer[512];
         audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
@@ -66,6 +66,243 @@ void testSampleOneshot() {
     audio_sampleOneshot("ding", &attr);
     waitSeconds(2);
 
+    // Test: handle lookup and handle based oneshots
+    std::cout << "Playing: 8 rapid shots by handle, volume=0.4\n";
+    if (audio_sampleGetHandle("ding") != handle) {
+        std::cout << "FAILURE: audio_sampleGetHandle returned a different handle\n";
+    }
+    attr = {0.0f, 0.4f, 1.0f};
+    for (int i = 0; i < 8; i++) {
+        if (audio_sampleOneshotHandle(handle, &attr) != 0) {
+            std::cout << "FAILURE: Failed to play by handle\n";
+            break;
+        }
+        waitMilliseconds(100);
+    }
+    waitSeconds(1);
+
+    // Test: layered batch, three shots starting on the same DSP clock, then a scheduled pattern
+    std::cout << "Playing: 3 layered shots in one batch (pitch 0.5 / 1.0 / 2.0)\n";
+    OneshotCmd layers[3] = {
+        {handle, {0.0f, 0.5f, 0.5f}, 0},
+        {handle, {0.0f, 0.5f, 1.0f}, 0},
+        {handle, {0.0f, 0.5f, 2.0f}, 0},
+    };
+    if (audio_sampleOneshotBatch(layers, 3) != 3) {
+        std::cout << "FAILURE: Failed to play batch\n";
+    }
+    waitSeconds(2);
+
+    std::cout << "Playing: 4 shots scheduled 250ms apart, starting 500ms from now\n";
+    unsigned long long clock = 0;
+    int rate = 0;
+    audio_coreGetDSPClock(&clock, &rate);
+    OneshotCmd pattern[4];
+    for (int i = 0; i < 4; i++) {
+        pattern[i] = {handle, {0.0f, 0.6f, 1.0f}, static_cast<unsigned int>(rate / 4 * i)};
+    }
+    if (audio_sampleOneshotScheduled(pattern, 4, clock + rate / 2, AUDIO_TIMEUNIT_DSPCLOCK) != 4) {
+        std::cout << "FAILURE: Failed to schedule oneshots\n";
+    }
+    waitSeconds(2);
+
+    // Test: sound group, played by key like a sample
+    std::cout << "Playing: sound group 'ding_var' 6 times (no repeat, pitch 0.8-1.25, volume 0.6-1.0)\n";
+    int low = audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "ding_low");
+    int members[2] = {handle, low};
+    SampleGroupConfig group_config = {0.8f, 1.25f, 0.6f, 1.0f, AUDIO_GROUP_NO_REPEAT};
+    if (low < 0 || audio_sampleGroupCreate("ding_var", members, 2, &group_config) < 0) {
+        std::cout << "FAILURE: Failed to create sound group\n";
+    } else {
+        attr = {0.0f, 1.0f, 1.0f};
+        for (int i = 0; i < 6; i++) {
+            audio_sampleOneshot("ding_var", &attr);
+            waitMilliseconds(300);
+        }
+        audio_sampleUnload("ding_var");
+        audio_sampleUnload("ding_low");
+    }
+    waitSeconds(1);
+
+    // Test: voice limit, 16 shots in a burst but only 2 may play at once
+    std::cout << "Playing: 16 shots in a burst, limited to 2 instances (oldest stolen)\n";
+    audio_sampleSetVoiceLimit("ding", 2, AUDIO_STEAL_OLDEST);
+    for (int i = 0; i < 16; i++) {
+        if (audio_sampleOneshot("ding", &attr) != 0) {
+            std::cout << "FAILURE: Failed to play with a voice limit\n";
+            break;
+        }
+    }
+    waitSeconds(1);
+
+    std::cout << "Playing: 4 shots limited to 2 instances (rejected)\n";
+    audio_sampleSetVoiceLimit("ding", 2, AUDIO_STEAL_REJECT);
+    int rejected = 0;
+    for (int i = 0; i < 4; i++) {
+        if (audio_sampleOneshot("ding", &attr) != 0) {
+            rejected++;
+        }
+    }
+    std::cout << (rejected == 2 ? "SUCCESS" : "FAILURE") << ": " << rejected << " shots rejected\n";
+    audio_sampleSetVoiceLimit("ding", 0, AUDIO_STEAL_OLDEST);
+    waitSeconds(1);
+
+    // Test: compressed in memory, compare with the decoded sample in the memory report
+    std::cout << "Loading 'ding_compressed' compressed in memory...\n";
+    SampleLoadOptions load_options = {AUDIO_SAMPLE_COMPRESSED, 0, 0, 0, 0.0f, 0.0f};
+    if (audio_sampleLoadEx(sample_data.data(), static_cast<int>(sample_data.size()), "ding_compressed", &load_options) < 0) {
+        std::cout << "FAILURE: Failed to load compressed sample\n";
+    } else {
+        SampleMemoryReport report;
+        audio_sampleGetMemoryReport(&report);
+        std::cout << "Decoded: " << report.decoded_count << " samples, " << report.decoded_bytes << " bytes\n";
+        std::cout << "Compressed: " << report.compressed_count << " samples, " << report.compressed_bytes
+                  << " bytes (" << report.compressed_pcm_bytes << " bytes decoded)\n";
+        attr = {0.0f, 1.0f, 1.0f};
+        audio_sampleOneshot("ding_compressed", &attr);
+        waitSeconds(1);
+        audio_sampleUnload("ding_compressed");
+    }
+
+    // Test: converted to the mixer rate at load, should sound the same as 'ding'
+    std::cout << "Loading 'ding_resampled' at the mixer rate...\n";
+    load_options = {AUDIO_SAMPLE_DECODED, 0, 0, AUDIO_SAMPLE_RESAMPLE, 0.0f, 0.0f};
+    if (audio_sampleLoadEx(sample_data.data(), static_cast<int>(sample_data.size()), "ding_resampled", &load_options) < 0) {
+        std::cout << "FAILURE: Failed to load resampled sample\n";
+    } else {
+        attr = {0.0f, 1.0f, 1.0f};
+        std::cout << (audio_sampleOneshot("ding_resampled", &attr) == 0 ? "SUCCESS" : "FAILURE") << ": Resampled sample played\n";
+        waitSeconds(1);
+        audio_sampleUnload("ding_resampled");
+    }
+
+    // Test: trimmed and normalized at load, the analysis is kept with the sample
+    std::cout << "Loading 'ding_normalized' trimmed and normalized to -18 LUFS...\n";
+    load_options = {AUDIO_SAMPLE_DECODED, 0, 0, AUDIO_SAMPLE_TRIM_SILENCE | AUDIO_SAMPLE_NORMALIZE, 0.0f, 0.0f};
+    SampleLoudness loudness;
+    if (audio_sampleLoadEx(sample_data.data(), static_cast<int>(sample_data.size()), "ding_normalized", &load_options) < 0 ||
+        audio_sampleGetLoudness("ding_normalized", &loudness) != 0) {
+        std::cout << "FAILURE: Failed to load analyzed sample\n";
+    } else {
+        std::cout << (loudness.analyzed ? "SUCCESS" : "FAILURE") << ": " << loudness.loudness_lufs << " LUFS, peak "
+                  << loudness.peak << ", gain " << loudness.gain << ", " << loudness.trimmed_ms << " ms trimmed\n";
+        attr = {0.0f, 1.0f, 1.0f};
+        audio_sampleOneshot("ding_normalized", &attr);
+        waitSeconds(1);
+        audio_sampleUnload("ding_normalized");
+    }
+
+    // Test: the same bytes under another key share the loaded sound
+    std::cout << "Loading the same data as 'ding_copy'...\n";
+    int copy_handle = audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "ding_copy");
+    if (copy_handle < 0) {
+        std::cout << "FAILURE: Failed to load sample copy\n";
+    } else {
+        SampleMemoryReport report;
+        audio_sampleGetMemoryReport(&report);
+        std::cout << (report.shared_count == 1 ? "SUCCESS" : "FAILURE") << ": " << report.shared_count
+                  << " shared, " << report.shared_saved_bytes << " bytes saved\n";
+    }
+
+    // Test: unload, the old handle must stop resolving
+    std::cout << "Unloading 'ding'...\n";
+    if (audio_sampleUnload("ding") != 0) {
+        std::cout << "FAILURE: Failed to unload sample\n";
+    } else if (audio_sampleOneshotHandle(handle, &attr) == 0) {
+        std::cout << "FAILURE: Unloaded handle still plays\n";
+    } else {
+        std::cout << "SUCCESS: Sample unloaded\n";
+    }
+
+    // 'ding_copy' keeps the shared sound alive after 'ding' is gone
+    if (copy_handle >= 0) {
+        attr = {0.0f, 1.0f, 1.0f};
+        std::cout << (audio_sampleOneshotHandle(copy_handle, &attr) == 0 ? "SUCCESS" : "FAILURE") << ": Shared copy still plays\n";
+        waitSeconds(1);
+        audio_sampleUnload("ding_copy");
+    }
+
+    // Test: registered sample under a tiny budget, evicted after playing and decoded again on the next play
+    std::cout << "Registering 'ding' lazily with a 1 byte budget...\n";
+    audio_sampleSetMemoryBudget(1);
+    handle = audio_sampleRegister(sample_data.data(), static_cast<int>(sample_data.size()), "ding");
+    int loaded_bytes = 0;
+    int budget_bytes = 0;
+    for (int i = 0; i < 3; i++) {
+        attr = {0.0f, 1.0f, 1.0f};
+        if (audio_sampleOneshotHandle(handle, &attr) != 0) {
+            std::cout << "FAILURE: Failed to play registered sample\n";
+            break;
+        }
+        audio_sampleGetMemoryUsage(&loaded_bytes, &budget_bytes);
+        std::cout << "Decoded: " << loaded_bytes << " bytes (budget " << budget_bytes << ")\n";
+        waitSeconds(3);
+        // Nothing is playing anymore, so changing the budget evicts it
+        audio_sampleSetMemoryBudget(1);
+        audio_sampleGetMemoryUsage(&loaded_bytes, &budget_bytes);
+        std::cout << "After eviction: " << loaded_bytes << " bytes\n";
+    }
+
+    // Test: asynchronous batch load, poll until every load has finished
+    std::cout << "Loading 4 samples asynchronously...\n";
+    const char* async_keys[4] = {"ding_async_0", "ding_async_1", "ding_async_2", "ding_async_3"};
+    SampleLoadRequest requests[4];
+    int async_handles[4];
+    int async_states[4];
+    for (int i = 0; i < 4; i++) {
+        requests[i] = {sample_data.data(), static_cast<int>(sample_data.size()), async_keys[i]};
+    }
+    if (audio_sampleLoadBatch(requests, 4, async_handles) != 4) {
+        std::cout << "FAILURE: Failed to start asynchronous loads\n";
+    } else {
+        int polls = 0;
+        while (audio_sampleGetOpenStateBatch(async_handles, 4, async_states) > 0) {
+            polls++;
+            waitMilliseconds(1);
+        }
+        std::cout << "Finished after " << polls << " polls\n";
+        attr = {0.0f, 0.6f, 1.0f};
+        for (int i = 0; i < 4; i++) {
+            if (async_states[i] != 0 || audio_sampleOneshotHandle(async_handles[i], &attr) != 0) {
+                std::cout << "FAILURE: " << async_keys[i] << " did not load (state " << async_states[i] << ")\n";
+            }
+            waitMilliseconds(250);
+        }
+        waitSeconds(1);
+    }
+
+    // Test: decoded PCM cache, the reload (and every load on the next launch) maps the cached PCM
+    std::cout << "Loading 'ding_cached' through the PCM cache in bin...\n";
+    audio_sampleSetPcmCache("bin");
+    for (int i = 0; i < 2; i++) {
+        if (audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "ding_cached") < 0) {
+            std::cout << "FAILURE: Failed to load sample through the PCM cache\n";
+            break;
+        }
+        attr = {0.0f, 1.0f, 1.0f};
+        audio_sampleOneshot("ding_cached", &attr);
+        waitSeconds(1);
+        audio_sampleUnload("ding_cached");
+    }
+    int cache_hits = 0;
+    int cache_misses = 0;
+    audio_sampleGetPcmCacheStats(&cache_hits, &cache_misses);
+    std::cout << (cache_hits >= 1 ? "SUCCESS" : "FAILURE") << ": " << cache_hits << " cache hits, " << cache_misses << " misses\n";
+    audio_sampleSetPcmCache(nullptr);
+
+    // Test: sample bank, keys are played straight from the mapped file
+    // Build it with: bin\bankpack.exe assets\samples.bank assets\ding.ogg assets\clap.wav
+    int bank = audio_bankMount("assets/samples.bank");
+    if (bank < 0) {
+        std::cout << "SKIPPED: assets/samples.bank not found, build it with bankpack\n";
+    } else {
+        std::cout << "Mounted bank with " << audio_bankGetSampleCount(bank) << " samples\n";
+        attr = {0.0f, 1.0f, 1.0f};
+        std::cout << (audio_sampleOneshot("clap", &attr) == 0 ? "SUCCESS" : "FAILURE") << ": Bank sample 'clap' played\n";
+        waitSeconds(1);
+        std::cout << (audio_bankUnmount(bank) == 0 ? "SUCCESS" : "FAILURE") << ": Bank unmounted\n";
+    }
+
     // Free audio backend
     freeAudioBackend();
 
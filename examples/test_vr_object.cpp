@@ -31,7 +31,7 @@ void testVrObject() {
         return;
     }
     result = audio_sampleLoad(missile_data.data(), static_cast<int>(missile_data.size()), "missile");
-    if (result != 0) {
+    if (result < 0) {
         std::cout << "FAILURE: Failed to load missile sample\n";
         char errorBuffer[512];
         audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
@@ -48,7 +48,7 @@ void testVrObject() {
         return;
     }
     result = audio_sampleLoad(explosion_data.data(), static_cast<int>(explosion_data.size()), "explosion");
-    if (result != 0) {
+    if (result < 0) {
         std::cout << "FAILURE: Failed to load explosion sample\n";
         char errorBuffer[512];
         audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
@@ -65,7 +65,7 @@ void testVrObject() {
         return;
     }
     result = audio_sampleLoad(gunloop_data.data(), static_cast<int>(gunloop_data.size()), "gunloop");
-    if (result != 0) {
+    if (result < 0) {
         std::cout << "FAILURE: Failed to load gunloop sample\n";
         char errorBuffer[512];
         audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
@@ -82,7 +82,7 @@ void testVrObject() {
         return;
     }
     result = audio_sampleLoad(gunend_data.data(), static_cast<int>(gunend_data.size()), "gunend");
-    if (result != 0) {
+    if (result < 0) {
         std::cout << "FAILURE: Failed to load gunend sample\n";
         char errorBuffer[512];
         audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
@@ -33,7 +33,7 @@ void testVrRoomEffects() {
     // Load sample with key
     std::cout << "Registering sample with key 'clap'...\n";
     result = audio_sampleLoad(sample_data.data(), static_cast<int>(sample_data.size()), "clap");
-    if (result != 0) {
+    if (result < 0) {
         std::cout << "FAILURE: Failed to load sample\n";
         char errorBuffer[512];
         audio_errorGetLast(errorBuffer, sizeof(errorBuffer));
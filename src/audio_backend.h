@@ -35,9 +35,90 @@ typedef struct {
     float height;  // Y in FMOD
 } UnitVector3D;
 
+// Output types for AudioCoreConfig.output_type (FMOD_OUTPUTTYPE values)
+#define AUDIO_OUTPUT_NOSOUND_NRT    4  // Headless, mixer advances only through audio_coreRenderFrames
+#define AUDIO_OUTPUT_WAVWRITER_NRT  5  // Same, and also writes the mix to wav_output_path
+
+// Mixer configuration for audio_coreInitializeEx
+// A value of 0 keeps the FMOD default for that field
+typedef struct {
+    int max_channels;       // Virtual channels, backend default 512
+    int real_voices;        // Real voices actually mixed
+    int sample_rate;        // Mixer sample rate in Hz
+    int speaker_mode;       // FMOD_SPEAKERMODE value
+    int dsp_buffer_length;  // Mixer block length in samples
+    int dsp_buffer_count;   // Number of mixer blocks
+    int output_type;        // FMOD_OUTPUTTYPE value
+                            // NOSOUND_NRT / WAVWRITER_NRT select the headless render mode
+    const char* wav_output_path;  // Output file for WAVWRITER_NRT, null for FMOD's default name
+    // Codec pool sizes, pre-allocated at init
+    int max_mpeg_codecs;
+    int max_adpcm_codecs;
+    int max_vorbis_codecs;
+    int max_fadpcm_codecs;
+    int max_opus_codecs;
+    // Preallocated arenas, 0 to use the system heap
+    int fmod_arena_bytes;     // Handed to FMOD (FMOD_Memory_Initialize)
+    int backend_arena_bytes;  // Backend's own allocations (keys, room strings, BGM buffers)
+} AudioCoreConfig;
+
 // Core API
 __declspec(dllimport) int audio_coreInitialize();
+__declspec(dllimport) int audio_coreInitializeEx(const AudioCoreConfig* config);
 __declspec(dllimport) void audio_coreFree();
+// Master DSP clock in samples at the mixer rate, for audio_sampleOneshotScheduled
+__declspec(dllimport) int audio_coreGetDSPClock(unsigned long long* clock, int* sample_rate);
+
+// Headless render API (non-realtime output types only)
+__declspec(dllimport) int audio_coreRenderFrames(int frames, float* buffer, int buffer_length);
+__declspec(dllimport) int audio_coreGetRenderFormat(int* sample_rate, int* channels);
+
+// Runtime statistics snapshot, refreshed by the working thread every update tick
+typedef struct {
+    // Mixer CPU usage in percent
+    float cpu_dsp;
+    float cpu_stream;
+    float cpu_geometry;
+    float cpu_update;
+    // Channels
+    int channels_real;
+    int channels_virtual;
+    // FMOD memory in bytes
+    int memory_current;
+    int memory_peak;
+    // Streams currently open
+    int open_streams;
+    // Working thread tick timing in milliseconds
+    float tick_ms;
+    float tick_max_ms;
+    float tick_jitter_ms;
+    float tick_interval_ms;
+    unsigned int tick_overruns;
+    // Number of times the snapshot has been refreshed
+    unsigned int snapshot_count;
+} AudioStats;
+
+// Memory usage of the FMOD arena and the backend arena
+typedef struct {
+    // FMOD arena, 0 when FMOD uses the system heap
+    int fmod_arena_bytes;
+    int fmod_current_bytes;
+    int fmod_peak_bytes;
+    // Backend arena, 0 when the backend uses the system heap
+    int backend_arena_bytes;
+    int backend_used_bytes;          // Live allocations, including block headers
+    int backend_peak_bytes;          // High-water mark of backend_used_bytes
+    int backend_cached_bytes;        // Freed small blocks kept for reuse
+    int backend_free_bytes;          // Unallocated arena bytes
+    int backend_largest_free_bytes;  // Largest single free range
+    float backend_fragmentation;     // 1 - largest free / free, 0 when the free space is contiguous
+    int backend_fallback_count;      // Allocations that went to the system heap because the arena was full
+    int backend_fallback_bytes;      // Live bytes on the system heap
+} AudioMemoryStats;
+
+// Statistics API
+__declspec(dllimport) int audio_coreGetStats(AudioStats* stats);
+__declspec(dllimport) int audio_coreGetMemoryStats(AudioMemoryStats* stats);
 
 // Version API
 __declspec(dllimport) int audio_versionGetMajor();
@@ -48,12 +129,151 @@ __declspec(dllimport) int audio_versionGetPatch();
 __declspec(dllimport) void audio_errorGetLast(char* buffer, int size);
 
 // Sample API
+// audio_sampleLoad returns the sample handle (> 0), or -1 on failure
 __declspec(dllimport) int audio_sampleLoad(const void* address, int size, const char* key);
+
+// Load modes for audio_sampleLoadEx
+#define AUDIO_SAMPLE_DECODED     0  // Decoded to PCM at load (audio_sampleLoad)
+#define AUDIO_SAMPLE_COMPRESSED  1  // Kept compressed (Vorbis / ADPCM / FADPCM), decoded while playing
+#define AUDIO_SAMPLE_AUTO        2  // Compressed if at least auto_min_length_ms long and max_instances is 1-2
+// Load flags for audio_sampleLoadEx, decoded samples only
+#define AUDIO_SAMPLE_RESAMPLE      1  // Convert to the mixer rate once at load
+#define AUDIO_SAMPLE_TRIM_SILENCE  2  // Cut leading and trailing silence
+#define AUDIO_SAMPLE_NORMALIZE     4  // Bake a gain that brings the sample to target_lufs into the PCM
+typedef struct {
+    int mode;                // AUDIO_SAMPLE_*
+    int max_instances;       // Voice limit (oldest stolen), 0 = unlimited
+    int auto_min_length_ms;  // 0 = 10 seconds
+    int flags;               // AUDIO_SAMPLE_RESAMPLE / TRIM_SILENCE / NORMALIZE
+    float silence_threshold_db;  // AUDIO_SAMPLE_TRIM_SILENCE threshold in dBFS, 0 = -60
+    float target_lufs;           // AUDIO_SAMPLE_NORMALIZE target loudness, 0 = -18 LUFS
+} SampleLoadOptions;
+// options can be NULL for the audio_sampleLoad behavior
+__declspec(dllimport) int audio_sampleLoadEx(const void* address, int size, const char* key, const SampleLoadOptions* options);
+
+typedef struct {
+    int decoded_count;
+    long long decoded_bytes;
+    int compressed_count;
+    long long compressed_bytes;      // Encoded data kept in memory
+    long long compressed_pcm_bytes;  // What the compressed samples would take decoded
+    int shared_count;                // Keys aliased to a sample loaded from the same bytes
+    long long shared_saved_bytes;    // Memory those keys would have taken on their own
+} SampleMemoryReport;
+__declspec(dllimport) int audio_sampleGetMemoryReport(SampleMemoryReport* report);
+
+// Load-time analysis of a sample loaded with AUDIO_SAMPLE_TRIM_SILENCE / AUDIO_SAMPLE_NORMALIZE
+typedef struct {
+    int analyzed;         // 0 if the sample was loaded without analysis
+    float loudness_lufs;  // Integrated loudness (ITU-R BS.1770) before the gain, -1000 if silent
+    float peak;           // Sample peak (linear) before the gain
+    float gain;           // Gain applied to the PCM (linear)
+    int trimmed_ms;       // Silence cut from both ends
+} SampleLoudness;
+__declspec(dllimport) int audio_sampleGetLoudness(const char* key, SampleLoudness* loudness);
+// Decoded PCM cache: decoded samples are stored in directory (must exist) and
+// mapped from there on the next launch instead of decoding again. NULL turns it off
+__declspec(dllimport) int audio_sampleSetPcmCache(const char* directory);
+__declspec(dllimport) int audio_sampleGetPcmCacheStats(int* hits, int* misses);
+
 __declspec(dllimport) int audio_sampleOneshot(const char* key, SoundAttributes* attributes);
+__declspec(dllimport) int audio_sampleGetHandle(const char* key);
+__declspec(dllimport) int audio_sampleOneshotHandle(int handle, SoundAttributes* attributes);
+
+// Sound groups: a key for up to 16 samples, one of them is picked per play
+// The group key / handle works with every oneshot function (audio_sampleOneshot*, audio_vrOneshot*, audio_vrObjectPlayOneshot*)
+// and is removed with audio_sampleUnload / audio_sampleUnloadHandle
+#define AUDIO_GROUP_RANDOM       0
+#define AUDIO_GROUP_ROUND_ROBIN  1
+#define AUDIO_GROUP_NO_REPEAT    2  // Random, but never the previous member twice in a row
+typedef struct {
+    float pitch_min;   // Pitch and volume are multiplied by a random value in [min, max]
+    float pitch_max;   // Leave both at 0 for no randomization
+    float volume_min;
+    float volume_max;
+    int policy;        // AUDIO_GROUP_*
+} SampleGroupConfig;
+// Returns the group handle (> 0), or -1 on failure. config can be NULL
+__declspec(dllimport) int audio_sampleGroupCreate(const char* key, const int* sample_handles, int count, const SampleGroupConfig* config);
+
+// Batched / scheduled oneshots, all commands start against one master DSP clock
+typedef struct {
+    int sample_handle;
+    SoundAttributes attributes;
+    unsigned int offset;  // Start offset from the batch start (ms for audio_sampleOneshotBatch)
+} OneshotCmd;
+
+#define AUDIO_TIMEUNIT_MS        0
+#define AUDIO_TIMEUNIT_DSPCLOCK  1  // Samples at the mixer rate
+// Both return the number of oneshots started, -1 on invalid parameters
+__declspec(dllimport) int audio_sampleOneshotBatch(const OneshotCmd* commands, int count);
+// start_clock from audio_coreGetDSPClock, 0 for the next mixer block
+__declspec(dllimport) int audio_sampleOneshotScheduled(const OneshotCmd* commands, int count, unsigned long long start_clock, int time_unit);
+
+// Voice limits: what happens when a sample is played at its max instances
+#define AUDIO_STEAL_OLDEST    0
+#define AUDIO_STEAL_QUIETEST  1
+#define AUDIO_STEAL_FARTHEST  2  // Rejects the new play if it is farther than every playing instance
+#define AUDIO_STEAL_REJECT    3
+// max_instances 0 = unlimited (default)
+__declspec(dllimport) int audio_sampleSetVoiceLimit(const char* key, int max_instances, int steal_policy);
+// Categories 0-15 map to an FMOD channel priority (0 most important - 256 least, default 128)
+// BGM always plays at priority 0
+__declspec(dllimport) int audio_sampleSetCategory(const char* key, int category);
+__declspec(dllimport) int audio_sampleSetCategoryPriority(int category, int priority);
+
+// One entry of audio_sampleLoadBatch
+typedef struct {
+    const void* address;  // Must stay valid until the load is no longer FMOD_OPENSTATE_LOADING (1)
+    int size;
+    const char* key;
+} SampleLoadRequest;
+
+// Asynchronous loads decode on FMOD's non-blocking threads, poll them with audio_sampleGetOpenState*
+// audio_sampleLoadBatch returns the number of loads started, failed entries get -1 in handles
+// audio_sampleGetOpenStateBatch returns the number still loading, invalid handles get -1 in states
+__declspec(dllimport) int audio_sampleLoadAsync(const void* address, int size, const char* key);
+__declspec(dllimport) int audio_sampleLoadBatch(const SampleLoadRequest* requests, int count, int* handles);
+__declspec(dllimport) int audio_sampleGetOpenState(const char* key);
+__declspec(dllimport) int audio_sampleGetOpenStateBatch(const int* handles, int count, int* states);
+
+// Registered samples are decoded on first use and evicted (least recently played first) over the budget
+// audio_sampleRegister does not copy, the memory must stay valid until the sample is unloaded
+__declspec(dllimport) int audio_sampleRegister(const void* address, int size, const char* key);
+__declspec(dllimport) int audio_sampleRegisterFile(const char* path, const char* key);
+__declspec(dllimport) int audio_sampleUnload(const char* key);
+__declspec(dllimport) int audio_sampleUnloadHandle(int handle);
+// Decoded PCM budget in bytes, 0 = unlimited
+__declspec(dllimport) int audio_sampleSetMemoryBudget(int bytes);
+__declspec(dllimport) int audio_sampleGetMemoryUsage(int* loaded_bytes, int* budget_bytes);
+
+// Sample banks (tools/bankpack): a memory-mapped file of samples, played in place
+// Bank keys are registered as samples on their first use, mounting doesn't read the samples
+__declspec(dllimport) int audio_bankMount(const char* path);
+__declspec(dllimport) int audio_bankUnmount(int bank);
+__declspec(dllimport) int audio_bankGetSampleCount(int bank);
 
 // BGM API
+// The load functions return a handle (> 0) with a generation, a handle is invalid once freed
 __declspec(dllimport) int audio_globalSetBgmVolume(float volume);
 __declspec(dllimport) int audio_bgmLoad(const void* address, int size);
+// Stream without copying: the memory must stay valid until audio_bgmFree
+__declspec(dllimport) int audio_bgmLoadPoint(const void* address, int size);
+// Stream from a file the backend memory-maps
+__declspec(dllimport) int audio_bgmLoadFile(const char* path);
+// Stream from disk, opened in the background: play calls fail until open_state is FMOD_OPENSTATE_READY
+__declspec(dllimport) int audio_bgmOpenStream(const char* path);
+// Buffers of the streams opened from now on, 0 = FMOD default (16 KB file buffer, 400 ms decoded)
+__declspec(dllimport) int audio_bgmSetStreamBufferSize(int file_buffer_bytes, int decode_buffer_ms);
+
+typedef struct {
+    int open_state;  // FMOD_OPENSTATE
+    int percent_buffered;
+    int starving;
+    int disk_busy;
+    int starve_count;
+} BgmStreamState;
+__declspec(dllimport) int audio_bgmGetStreamState(int slot, BgmStreamState* state);
 __declspec(dllimport) int audio_bgmPause(int slot);
 __declspec(dllimport) int audio_bgmResume(int slot);
 __declspec(dllimport) int audio_bgmStop(int slot);
@@ -62,8 +282,45 @@ __declspec(dllimport) int audio_bgmFadein(int slot, int ms);
 __declspec(dllimport) int audio_bgmCrossfade(int slot1, int slot2, int ms);
 __declspec(dllimport) int audio_bgmSetLoopPoint(int slot, int ms);
 __declspec(dllimport) int audio_bgmPlay(int slot);
+
 __declspec(dllimport) int audio_bgmFree(int slot);
 
+// Quantized transitions: start on the playing BGM's next beat, bar or marker, on the DSP clock
+#define AUDIO_BGM_QUANTIZE_NONE    0  // A few mixer blocks from now
+#define AUDIO_BGM_QUANTIZE_BEAT    1
+#define AUDIO_BGM_QUANTIZE_BAR     2
+#define AUDIO_BGM_QUANTIZE_MARKER  3  // Cue points in the file, or audio_bgmAddMarker
+// bpm 0 clears the tempo; first_beat_ms is the first downbeat, bars are counted from it
+__declspec(dllimport) int audio_bgmSetTempo(int slot, float bpm, int beats_per_bar, int first_beat_ms);
+__declspec(dllimport) int audio_bgmAddMarker(int slot, int ms);
+// Also removes the cue points read from the file
+__declspec(dllimport) int audio_bgmClearMarkers(int slot);
+// Same clock as audio_coreGetDSPClock, usable with audio_sampleOneshotScheduled (AUDIO_TIMEUNIT_DSPCLOCK)
+__declspec(dllimport) int audio_bgmGetQuantizedClock(int slot, int quantize, unsigned long long* clock);
+// slot2 starts (from its first downbeat if it has a tempo) and fades in while slot1 fades out, from slot1's next boundary
+__declspec(dllimport) int audio_bgmCrossfadeQuantized(int slot1, int slot2, int ms, int quantize);
+
+// BGM playlists: segments (BGM handles) started back to back on the DSP clock
+// Every segment but the last plays once, to its end (end_ms = -1) or up to end_ms; the last one loops
+// Segments must be open (audio_bgmOpenStream: open_state ready) when appended
+__declspec(dllimport) int audio_bgmPlaylistCreate();
+__declspec(dllimport) int audio_bgmPlaylistFree(int playlist);
+__declspec(dllimport) int audio_bgmPlaylistAppend(int playlist, int slot, int end_ms);
+__declspec(dllimport) int audio_bgmPlaylistPlay(int playlist);
+__declspec(dllimport) int audio_bgmPlaylistStop(int playlist);
+// Index of the segment playing, -1 when stopped
+__declspec(dllimport) int audio_bgmPlaylistGetSegment(int playlist, int* segment);
+
+// Music groups: BGM slots played as layers (stems) of one piece, started on one DSP clock and kept in phase
+// Returns the group handle (> 0), up to 8 layers; the slots stay owned by the caller
+__declspec(dllimport) int audio_musicGroupCreate(const int* slots, int count);
+__declspec(dllimport) int audio_musicGroupFree(int group);
+__declspec(dllimport) int audio_musicGroupPlay(int group);
+__declspec(dllimport) int audio_musicGroupStop(int group);
+// Ramp a layer (index in the slots given to create) to volume over ms
+__declspec(dllimport) int audio_musicGroupSetLayerVolume(int group, int layer, float volume, int ms);
+__declspec(dllimport) int audio_musicGroupSetLoopPoint(int group, int ms);
+
 // Wall materials structure for room effect
 typedef struct {
     const char* front;
@@ -81,11 +338,24 @@ typedef struct {
     const char* looped_sample_key;  // Can be NULL if no looped sound
 } VRObjectInfo;
 
+// VR initialization options for audio_vrInitializeEx
+// A value of 0 uses the default for that field
+typedef struct {
+    int source_pool_size;      // Resonance source DSPs created up front for oneshots, default 32
+    int source_pool_grow_by;   // DSPs added when the pool runs dry, default 8, -1 to never grow
+    int source_pool_max_size;  // Upper bound on pooled DSPs, default 256
+} VrInitConfig;
+
 // VR Audio API
 __declspec(dllimport) int audio_vrInitialize(const char* plugin_path);
+__declspec(dllimport) int audio_vrInitializeEx(const char* plugin_path, const VrInitConfig* config);
+__declspec(dllimport) int audio_vrGetSourcePoolStats(int* in_use, int* total);
 __declspec(dllimport) int audio_vrOneshotRelative(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow);
 __declspec(dllimport) int audio_vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes);
 __declspec(dllimport) int audio_vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes);
+__declspec(dllimport) int audio_vrOneshotRelativeHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow);
+__declspec(dllimport) int audio_vrOneshotAbsoluteHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes);
+__declspec(dllimport) int audio_vrOneshotPlayerHandle(int sample_handle, SoundAttributes* sound_attributes);
 __declspec(dllimport) int audio_vrPlayerSetPosition(float width, float depth, float height);
 __declspec(dllimport) int audio_vrPlayerSetRotation(const UnitVector3D* front, const UnitVector3D* up);
 __declspec(dllimport) int audio_vrRoomAdd(Position3D centerPosition, Size3D roomSize, WallMaterials* materials);
@@ -99,6 +369,7 @@ __declspec(dllimport) int audio_vrObjectStartLooping(const char* key);
 __declspec(dllimport) int audio_vrObjectPauseLooping(const char* key);
 __declspec(dllimport) int audio_vrObjectResumeLooping(const char* key);
 __declspec(dllimport) int audio_vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAttributes* attributes);
+__declspec(dllimport) int audio_vrObjectPlayOneshotHandle(const char* object_key, int sample_handle, SoundAttributes* attributes);
 __declspec(dllimport) int audio_vrObjectChangePosition(const char* key, Position3D pos);
 
 // Plugin Inspector API
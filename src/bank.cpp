@@ -0,0 +1,110 @@
+#include "bank.h"
+#include "context.h"
+#include "sample.h"
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+// Bank of a live bank id, or null (sets the last error)
+static MountedBank* getBank(int bank) {
+    auto& banks = g_context->GetBanks();
+    if (bank < 0 || bank >= static_cast<int>(banks.size()) || !banks[bank].is_used) {
+        g_context->SetLastError("Invalid bank: " + std::to_string(bank));
+        return nullptr;
+    }
+    return &banks[bank];
+}
+
+int bankMount(const char* path) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (path == nullptr || path[0] == '\0') {
+        g_context->SetLastError("Invalid parameter: path cannot be null or empty");
+        return -1;
+    }
+
+    // Only the header is read here, the index and the samples are paged in when they are looked up
+    MountedBank mounted;
+    std::string error;
+    if (!mapFile(path, &mounted.mapped, &error)) {
+        g_context->SetLastError(error);
+        return -1;
+    }
+    if (!openBankImage(mounted.mapped.data, mounted.mapped.size, &mounted.image, &error)) {
+        g_context->SetLastError(error + ": " + path);
+        unmapFile(&mounted.mapped);
+        return -1;
+    }
+    mounted.is_used = true;
+
+    auto& banks = g_context->GetBanks();
+    for (size_t i = 0; i < banks.size(); i++) {
+        if (!banks[i].is_used) {
+            banks[i] = mounted;
+            return static_cast<int>(i);
+        }
+    }
+    banks.push_back(mounted);
+    return static_cast<int>(banks.size() - 1);
+}
+
+int bankUnmount(int bank) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    MountedBank* mounted = getBank(bank);
+    if (mounted == nullptr) {
+        return -1;
+    }
+
+    // Sounds opened with FMOD_OPENMEMORY_POINT read the mapping, release them first
+    if (unloadBankSamples(bank) != 0) {
+        return -1;
+    }
+    unmapFile(&mounted->mapped);
+    *mounted = MountedBank();
+    return 0;
+}
+
+int bankGetSampleCount(int bank) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    MountedBank* mounted = getBank(bank);
+    if (mounted == nullptr) {
+        return -1;
+    }
+    return static_cast<int>(mounted->image.entry_count);
+}
+
+bool findBankSample(const char* key, BankSample* sample) {
+    auto& banks = g_context->GetBanks();
+    for (size_t i = 0; i < banks.size(); i++) {
+        if (!banks[i].is_used) {
+            continue;
+        }
+        const BankEntry* entry = findBankEntry(banks[i].image, key);
+        if (entry != nullptr) {
+            sample->data = banks[i].image.data + entry->data_offset;
+            sample->size = static_cast<int>(entry->data_size);
+            sample->compressed = (entry->flags & BANK_ENTRY_COMPRESSED) != 0;
+            sample->bank = static_cast<int>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void bankShutdown() {
+    if (g_context == nullptr) {
+        return;
+    }
+    for (MountedBank& mounted : g_context->GetBanks()) {
+        unmapFile(&mounted.mapped);
+        mounted = MountedBank();
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef BANK_H
+#define BANK_H
+
+// Mount a sample bank file (tools/bankpack) by memory-mapping it
+// Returns the bank id (>= 0), or -1 on failure
+int bankMount(const char* path);
+// Unload the bank's samples and unmap it, fails if one is a VR object's looped sound
+int bankUnmount(int bank);
+// Number of samples in the bank, -1 if not mounted
+int bankGetSampleCount(int bank);
+
+// A sample found in a mounted bank, data points into the mapping
+struct BankSample {
+    const void* data;
+    int size;
+    bool compressed;
+    int bank;
+};
+
+// Look a key up in the mounted banks in bank id order, false if no bank has it
+bool findBankSample(const char* key, BankSample* sample);
+
+// Unmap every bank, after the FMOD system (and every sound reading a bank) is released
+void bankShutdown();
+
+#endif // BANK_H
@@ -0,0 +1,175 @@
+#include "bank_format.h"
+#include <algorithm>
+#include <cstring>
+
+static const char BANK_MAGIC[4] = {'A', 'B', 'N', 'K'};
+
+bool openBankImage(const void* data, size_t size, BankImage* image, std::string* error) {
+    if (data == nullptr || size < sizeof(BankHeader)) {
+        *error = "Not a sample bank: file is too small";
+        return false;
+    }
+
+    BankHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, BANK_MAGIC, sizeof(BANK_MAGIC)) != 0) {
+        *error = "Not a sample bank: bad magic";
+        return false;
+    }
+    if (header.version != BANK_VERSION) {
+        *error = "Unsupported sample bank version: " + std::to_string(header.version);
+        return false;
+    }
+
+    // Offsets are compared against the remaining size so nothing can overflow
+    uint64_t index_bytes = static_cast<uint64_t>(header.entry_count) * sizeof(BankEntry);
+    if (header.index_offset > size || index_bytes > size - header.index_offset ||
+        header.index_offset % alignof(BankEntry) != 0 ||
+        header.names_offset > size || header.names_size > size - header.names_offset) {
+        *error = "Corrupt sample bank: index out of bounds";
+        return false;
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    image->data = bytes;
+    image->size = size;
+    image->entries = reinterpret_cast<const BankEntry*>(bytes + header.index_offset);
+    image->entry_count = header.entry_count;
+    image->names = reinterpret_cast<const char*>(bytes + header.names_offset);
+    image->names_size = header.names_size;
+    return true;
+}
+
+// Compare an entry's name with a key the way strcmp would, -2 if the name is out of bounds
+static int compareEntryName(const BankImage& image, const BankEntry& entry, const char* key, size_t key_length) {
+    if (entry.name_offset > image.names_size || entry.name_length > image.names_size - entry.name_offset) {
+        return -2;
+    }
+    size_t length = std::min<size_t>(entry.name_length, key_length);
+    int result = memcmp(image.names + entry.name_offset, key, length);
+    if (result != 0) {
+        return result < 0 ? -1 : 1;
+    }
+    if (entry.name_length == key_length) {
+        return 0;
+    }
+    return entry.name_length < key_length ? -1 : 1;
+}
+
+const BankEntry* findBankEntry(const BankImage& image, const char* key) {
+    size_t key_length = strlen(key);
+    uint32_t low = 0;
+    uint32_t high = image.entry_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const BankEntry& entry = image.entries[mid];
+        int order = compareEntryName(image, entry, key, key_length);
+        if (order == -2) {
+            return nullptr;
+        }
+        if (order == 0) {
+            if (entry.data_offset > image.size || entry.data_size > image.size - entry.data_offset ||
+                entry.data_size == 0 || entry.data_size > static_cast<uint32_t>(INT32_MAX)) {
+                return nullptr;
+            }
+            return &entry;
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+
+bool isPcmWave(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if (size < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    // Walk the chunks up to "fmt "
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        uint32_t chunk_size = static_cast<uint32_t>(bytes[offset + 4]) | (static_cast<uint32_t>(bytes[offset + 5]) << 8) |
+            (static_cast<uint32_t>(bytes[offset + 6]) << 16) | (static_cast<uint32_t>(bytes[offset + 7]) << 24);
+        if (memcmp(bytes + offset, "fmt ", 4) == 0) {
+            if (chunk_size < 2 || offset + 10 > size) {
+                return false;
+            }
+            // WAVE_FORMAT_PCM, WAVE_FORMAT_IEEE_FLOAT (extensible is left to the decoder)
+            unsigned int format = bytes[offset + 8] | (bytes[offset + 9] << 8);
+            return format == 1 || format == 3;
+        }
+        // Chunks are padded to an even size
+        offset += 8 + static_cast<size_t>(chunk_size) + (chunk_size & 1);
+    }
+    return false;
+}
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool buildBank(std::vector<BankInput>& inputs, std::vector<char>* bank, std::string* error) {
+    std::sort(inputs.begin(), inputs.end(), [](const BankInput& a, const BankInput& b) {
+        return strcmp(a.key.c_str(), b.key.c_str()) < 0;
+    });
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (inputs[i].key.empty() || inputs[i].data.empty()) {
+            *error = "Empty key or sample data: '" + inputs[i].key + "'";
+            return false;
+        }
+        if (i > 0 && inputs[i].key == inputs[i - 1].key) {
+            *error = "Duplicate key: '" + inputs[i].key + "'";
+            return false;
+        }
+        if (inputs[i].data.size() > static_cast<size_t>(INT32_MAX)) {
+            *error = "Sample is too large: '" + inputs[i].key + "'";
+            return false;
+        }
+    }
+
+    BankHeader header = {};
+    memcpy(header.magic, BANK_MAGIC, sizeof(BANK_MAGIC));
+    header.version = BANK_VERSION;
+    header.entry_count = static_cast<uint32_t>(inputs.size());
+    header.index_offset = sizeof(BankHeader);
+    header.names_offset = header.index_offset + inputs.size() * sizeof(BankEntry);
+
+    std::vector<BankEntry> entries(inputs.size());
+    std::string names;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        entries[i].name_offset = static_cast<uint32_t>(names.size());
+        entries[i].name_length = static_cast<uint32_t>(inputs[i].key.size());
+        names += inputs[i].key;
+        names += '\0';
+    }
+    if (names.size() > UINT32_MAX) {
+        *error = "Too many keys";
+        return false;
+    }
+    header.names_size = static_cast<uint32_t>(names.size());
+
+    uint64_t offset = header.names_offset + names.size();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        offset = alignUp(offset, BANK_PAYLOAD_ALIGNMENT);
+        entries[i].flags = isPcmWave(inputs[i].data.data(), inputs[i].data.size()) ? 0 : BANK_ENTRY_COMPRESSED;
+        entries[i].data_size = static_cast<uint32_t>(inputs[i].data.size());
+        entries[i].data_offset = offset;
+        offset += inputs[i].data.size();
+    }
+
+    bank->assign(static_cast<size_t>(offset), 0);
+    char* out = bank->data();
+    memcpy(out, &header, sizeof(header));
+    if (!entries.empty()) {
+        memcpy(out + header.index_offset, entries.data(), entries.size() * sizeof(BankEntry));
+    }
+    memcpy(out + header.names_offset, names.data(), names.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        memcpy(out + entries[i].data_offset, inputs[i].data.data(), inputs[i].data.size());
+    }
+    return true;
+}
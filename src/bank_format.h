@@ -0,0 +1,71 @@
+#ifndef BANK_FORMAT_H
+#define BANK_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sample bank file, shared by the DLL (bank.cpp) and the packer (tools/bankpack.cpp)
+// Layout: BankHeader, BankEntry index sorted by key (strcmp order), key names (NUL terminated),
+// then the payloads, each starting on a BANK_PAYLOAD_ALIGNMENT boundary
+// All fields are little endian
+
+const uint32_t BANK_VERSION = 1;
+// Payloads never share a cache line, and a page holds as few samples as possible
+const uint32_t BANK_PAYLOAD_ALIGNMENT = 64;
+
+// BankEntry::flags
+const uint32_t BANK_ENTRY_COMPRESSED = 1;  // Not a PCM WAV, opened with FMOD_CREATECOMPRESSEDSAMPLE
+
+struct BankHeader {
+    char magic[4];  // "ABNK"
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t names_size;
+    uint64_t index_offset;  // BankEntry[entry_count]
+    uint64_t names_offset;
+};
+
+struct BankEntry {
+    uint32_t name_offset;  // From BankHeader::names_offset
+    uint32_t name_length;  // Without the NUL
+    uint32_t flags;  // BANK_ENTRY_*
+    uint32_t data_size;
+    uint64_t data_offset;  // From the start of the file
+};
+
+// A validated bank image, pointing into the caller's memory
+struct BankImage {
+    const unsigned char* data;
+    size_t size;
+    const BankEntry* entries;
+    uint32_t entry_count;
+    const char* names;
+    uint32_t names_size;
+
+    BankImage() : data(nullptr), size(0), entries(nullptr), entry_count(0), names(nullptr), names_size(0) {}
+};
+
+// Check the header and the index / name table bounds, entries are checked on lookup
+// Doesn't touch the index or the payloads, so it costs the same for any bank size
+// Returns false and fills error on failure
+bool openBankImage(const void* data, size_t size, BankImage* image, std::string* error);
+
+// Binary search the index, null if the key is not in the bank or its entry is out of bounds
+const BankEntry* findBankEntry(const BankImage& image, const char* key);
+
+// True for a RIFF WAVE holding integer or float PCM, which FMOD_OPENMEMORY_POINT can play in place
+bool isPcmWave(const void* data, size_t size);
+
+// One sample for buildBank
+struct BankInput {
+    std::string key;
+    std::vector<char> data;
+};
+
+// Write a bank of the inputs, sorted by key
+// Returns false and fills error on failure (duplicate or empty keys, too large)
+bool buildBank(std::vector<BankInput>& inputs, std::vector<char>* bank, std::string* error);
+
+#endif // BANK_FORMAT_H
@@ -1,12 +1,150 @@
 #include "bgm.h"
+#include "bgm_playlist.h"
 #include "context.h"
+#include "stats.h"
+#include "mapped_file.h"
 #include "fmod/fmod.hpp"
 #include "fmod/fmod_errors.h"
+#include <climits>
+#include <cmath>
 #include <cstring>
 
 // External declaration of global context
 extern AudioBackendContext* g_context;
 
+// FMOD channel priority of BGM, 0 is the most important
+static const int BGM_PRIORITY = 0;
+
+// FMOD's own stream file buffer, restored when bgmSetStreamBufferSize is given 0
+static const unsigned int DEFAULT_STREAM_FILE_BUFFER_BYTES = 16384;
+
+// Queue a channel command for the working thread
+static bool pushChannelCommand(AudioCommandType type, FMOD::Channel* channel, bool paused, float target_volume, int fade_ms) {
+    AudioCommand command;
+    command.type = type;
+    command.channel.channel = channel;
+    command.channel.paused = paused;
+    command.channel.target_volume = target_volume;
+    command.channel.fade_ms = fade_ms;
+    return g_context->PushCommand(command);
+}
+
+// BGM channels get the highest priority so voice stealing never takes them
+static void setBgmPriority(FMOD::Sound* sound) {
+    float frequency = 0.0f;
+    int priority = 0;
+    sound->getDefaults(&frequency, &priority);
+    sound->setDefaults(frequency, BGM_PRIORITY);
+}
+
+static int makeBgmHandle(int index, unsigned int generation) {
+    return static_cast<int>(generation << BGM_HANDLE_INDEX_BITS) | index;
+}
+
+// The generation check keeps a handle to a freed slot from controlling the track loaded into it next
+BgmSlot* resolveBgmSlot(int handle) {
+    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
+    size_t index = static_cast<size_t>(handle & BGM_HANDLE_INDEX_MASK);
+    unsigned int generation = static_cast<unsigned int>(handle >> BGM_HANDLE_INDEX_BITS) & BGM_HANDLE_GENERATION_MASK;
+    if (handle <= 0 || (handle & MUSIC_GROUP_HANDLE_BIT) != 0 || index >= slots.size() || !slots[index].is_used || slots[index].generation != generation) {
+        g_context->SetLastError("Invalid BGM handle: " + std::to_string(handle));
+        return nullptr;
+    }
+    return &slots[index];
+}
+
+// Decode buffer of a new BGM stream in PCM samples (approximated at the mixer rate), 0 for FMOD's default
+static unsigned int streamDecodeBufferSize() {
+    int ms = g_context->GetBgmStreamSettings().decode_buffer_ms;
+    if (ms == 0) {
+        return 0;
+    }
+    int rate = 0;
+    g_context->GetFmodSystem()->getSoftwareFormat(&rate, nullptr, nullptr);
+    return static_cast<unsigned int>(static_cast<long long>(ms) * rate / 1000);
+}
+
+// Set up a bgmOpenStream stream the first time it is seen ready
+bool checkBgmReady(BgmSlot* bgm) {
+    if (!bgm->is_opening) {
+        return true;
+    }
+
+    FMOD_OPENSTATE state = FMOD_OPENSTATE_READY;
+    FMOD_RESULT result = bgm->sound->getOpenState(&state, nullptr, nullptr, nullptr);
+    if (result != FMOD_OK || state == FMOD_OPENSTATE_ERROR) {
+        g_context->SetLastError(std::string("Failed to open BGM stream: ") + FMOD_ErrorString(result != FMOD_OK ? result : FMOD_ERR_FILE_BAD));
+        return false;
+    }
+    if (state == FMOD_OPENSTATE_LOADING || state == FMOD_OPENSTATE_CONNECTING) {
+        g_context->SetLastError("BGM stream is still opening");
+        return false;
+    }
+
+    // Defaults can't be set while the sound is opening
+    bgm->is_opening = false;
+    setBgmPriority(bgm->sound);
+    return true;
+}
+
+// Channels are scheduled this many mixer blocks ahead, so every channel set up for the clock
+// is waiting for it before the mixer gets there
+static const unsigned int SCHEDULE_LEAD_BLOCKS = 4;
+
+unsigned long long getBgmScheduleLead(FMOD::System* system) {
+    unsigned int block_length = 0;
+    int block_count = 0;
+    system->getDSPBufferSize(&block_length, &block_count);
+    return static_cast<unsigned long long>(block_length) * SCHEDULE_LEAD_BLOCKS;
+}
+
+bool getBgmStartClock(unsigned long long* clock) {
+    FMOD::System* system = g_context->GetFmodSystem();
+    FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
+    if (system == nullptr || bgmGroup == nullptr) {
+        g_context->SetLastError("BGM channel group is not available");
+        return false;
+    }
+
+    unsigned long long now = 0;
+    FMOD_RESULT result = bgmGroup->getDSPClock(&now, nullptr);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to get DSP clock: ") + FMOD_ErrorString(result));
+        return false;
+    }
+
+    *clock = now + getBgmScheduleLead(system);
+    return true;
+}
+
+// Take a slot from the free list, or grow the table, and return its handle with a new generation
+// Returns -1 (sets the last error) when the handle can't address any more slots
+static int allocateBgmSlot() {
+    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
+    std::vector<int>& free_slots = g_context->GetBgmFreeSlots();
+
+    int index;
+    if (!free_slots.empty()) {
+        index = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        if (slots.size() > static_cast<size_t>(BGM_HANDLE_INDEX_MASK)) {
+            g_context->SetLastError("Too many BGM slots in use");
+            return -1;
+        }
+        slots.push_back(BgmSlot());
+        index = static_cast<int>(slots.size() - 1);
+    }
+
+    // Generation 0 is never used, so a handle is always positive
+    BgmSlot& slot = slots[index];
+    unsigned int generation = (slot.generation % BGM_HANDLE_GENERATION_MASK) + 1;
+    slot = BgmSlot();
+    slot.generation = generation;
+    slot.is_used = true;
+    return makeBgmHandle(index, generation);
+}
+
 // Set global BGM volume
 int globalSetBgmVolume(float volume) {
     if (!isBackendInitialized()) {
@@ -19,15 +157,18 @@ int globalSetBgmVolume(float volume) {
         return -1;
     }
 
-    FMOD_RESULT result = bgmGroup->setVolume(volume);
-    if (result != FMOD_OK) {
-        g_context->SetLastError(std::string("Failed to set BGM volume: ") + FMOD_ErrorString(result));
+    AudioCommand command;
+    command.type = AUDIO_COMMAND_SET_GROUP_VOLUME;
+    command.group.group = bgmGroup;
+    command.group.channel = nullptr;
+    command.group.volume = volume;
+    if (!g_context->PushCommand(command)) {
         return -1;
     }
     return 0;
 }
 
-// Load BGM from memory and return slot number
+// Load BGM from memory and return its handle
 int bgmLoad(const void* address, int size) {
     if (!isBackendInitialized()) {
         return -1;
@@ -38,24 +179,9 @@ int bgmLoad(const void* address, int size) {
         return -1;
     }
 
-    // Find an empty slot
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    int slot_index = -1;
-    for (size_t i = 0; i < slots.size(); i++) {
-        if (!slots[i].is_used) {
-            slot_index = static_cast<int>(i);
-            break;
-        }
-    }
-
-    if (slot_index == -1) {
-        g_context->SetLastError("No available BGM slots");
-        return -1;
-    }
-
     // Copy the memory buffer since FMOD_OPENMEMORY will duplicate it
-    // but we want to be safe and manage our own copy
-    void* buffer_copy = malloc(size);
+    // but we want to be safe and manage our own copy (from the backend arena)
+    void* buffer_copy = poolAllocate(size);
     if (buffer_copy == nullptr) {
         g_context->SetLastError("Failed to allocate memory for BGM buffer");
         return -1;
@@ -79,42 +205,253 @@ int bgmLoad(const void* address, int size) {
 
     if (result != FMOD_OK) {
         g_context->SetLastError(std::string("Failed to create BGM sound: ") + FMOD_ErrorString(result));
-        free(buffer_copy);
+        poolFree(buffer_copy);
+        return -1;
+    }
+    setBgmPriority(sound);
+
+    int handle = allocateBgmSlot();
+    if (handle < 0) {
+        sound->release();
+        poolFree(buffer_copy);
         return -1;
     }
 
     // Store in slot
-    slots[slot_index].sound = sound;
-    slots[slot_index].buffer = buffer_copy;
-    slots[slot_index].is_used = true;
-    slots[slot_index].channel = nullptr;
-    slots[slot_index].loop_point_ms = -1;
+    BgmSlot& slot = g_context->GetBgmSlots()[handle & BGM_HANDLE_INDEX_MASK];
+    slot.sound = sound;
+    slot.buffer = buffer_copy;
+    slot.is_stream = false;
 
-    return slot_index;
+    return handle;
 }
 
-// Pause BGM
-int bgmPause(int slot) {
+// Create a BGM stream directly over memory that outlives the sound, store it in a free slot and return its handle
+// mapped is the file the memory belongs to (kept in the slot and unmapped by bgmFree), or empty
+static int loadBgmStream(const void* address, size_t size, const MappedFile& mapped) {
+    FMOD::System* system = g_context->GetFmodSystem();
+    if (system == nullptr) {
+        return -1;
+    }
+
+    if (size > 0xFFFFFFFFu) {
+        g_context->SetLastError("BGM data is too large: " + std::to_string(size) + " bytes");
+        return -1;
+    }
+
+    FMOD::Sound* sound = nullptr;
+    FMOD_CREATESOUNDEXINFO exinfo;
+    memset(&exinfo, 0, sizeof(FMOD_CREATESOUNDEXINFO));
+    exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+    exinfo.length = static_cast<unsigned int>(size);
+    exinfo.decodebuffersize = streamDecodeBufferSize();
+
+    // FMOD_OPENMEMORY_POINT reads the data in place instead of duplicating it,
+    // FMOD_CREATESTREAM decodes it a block at a time instead of all at once
+    FMOD_RESULT result = system->createSound(
+        static_cast<const char*>(address),
+        FMOD_OPENMEMORY_POINT | FMOD_CREATESTREAM | FMOD_LOOP_NORMAL,
+        &exinfo,
+        &sound
+    );
+
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to create BGM stream: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+    setBgmPriority(sound);
+
+    int handle = allocateBgmSlot();
+    if (handle < 0) {
+        sound->release();
+        return -1;
+    }
+    noteStreamOpened();
+
+    // Store in slot
+    BgmSlot& slot = g_context->GetBgmSlots()[handle & BGM_HANDLE_INDEX_MASK];
+    slot.sound = sound;
+    slot.mapped = mapped;
+    slot.is_stream = true;
+
+    return handle;
+}
+
+// Load BGM as a stream over caller memory without copying it and return its handle
+// The memory must stay valid until bgmFree
+int bgmLoadPoint(const void* address, int size) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+
+    if (address == nullptr || size <= 0) {
+        g_context->SetLastError("Invalid parameters: address cannot be null and size must be positive");
         return -1;
     }
 
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
+    return loadBgmStream(address, static_cast<size_t>(size), MappedFile());
+}
+
+// Load BGM as a stream over a memory-mapped file and return its handle
+int bgmLoadFile(const char* path) {
+    if (!isBackendInitialized()) {
         return -1;
     }
 
-    if (slots[slot].channel != nullptr) {
-        FMOD_RESULT result = slots[slot].channel->setPaused(true);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to pause BGM: ") + FMOD_ErrorString(result));
+    if (path == nullptr) {
+        g_context->SetLastError("Invalid parameter: path cannot be null");
+        return -1;
+    }
+
+    MappedFile mapped;
+    std::string error;
+    if (!mapFile(path, &mapped, &error)) {
+        g_context->SetLastError(error);
+        return -1;
+    }
+
+    int handle = loadBgmStream(mapped.data, mapped.size, mapped);
+    if (handle < 0) {
+        unmapFile(&mapped);
+    }
+    return handle;
+}
+
+// Open a BGM stream that reads the file from disk as it plays and return its handle
+// The file is opened in the background (FMOD_NONBLOCKING), play calls fail until it is ready
+int bgmOpenStream(const char* path) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (path == nullptr) {
+        g_context->SetLastError("Invalid parameter: path cannot be null");
+        return -1;
+    }
+
+    FMOD::System* system = g_context->GetFmodSystem();
+    if (system == nullptr) {
+        return -1;
+    }
+
+    FMOD::Sound* sound = nullptr;
+    FMOD_CREATESOUNDEXINFO exinfo;
+    memset(&exinfo, 0, sizeof(FMOD_CREATESOUNDEXINFO));
+    exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+    exinfo.decodebuffersize = streamDecodeBufferSize();
+
+    // Only the file buffer and the decode buffer are resident, the file is read a block at a time
+    FMOD_RESULT result = system->createSound(
+        path,
+        FMOD_CREATESTREAM | FMOD_LOOP_NORMAL | FMOD_NONBLOCKING,
+        &exinfo,
+        &sound
+    );
+
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to open BGM stream: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+
+    int handle = allocateBgmSlot();
+    if (handle < 0) {
+        sound->release();
+        return -1;
+    }
+    noteStreamOpened();
+
+    // The priority is set by checkBgmReady once the stream has opened
+    BgmSlot& slot = g_context->GetBgmSlots()[handle & BGM_HANDLE_INDEX_MASK];
+    slot.sound = sound;
+    slot.is_stream = true;
+    slot.is_opening = true;
+
+    return handle;
+}
+
+// Set the buffers of the BGM streams opened from now on, 0 for FMOD's default
+// file_buffer_bytes: read from the file per access (System::setStreamBufferSize)
+// decode_buffer_ms: decoded ahead of the playback position
+int bgmSetStreamBufferSize(int file_buffer_bytes, int decode_buffer_ms) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (file_buffer_bytes < 0 || decode_buffer_ms < 0) {
+        g_context->SetLastError("Invalid parameters: buffer sizes cannot be negative");
+        return -1;
+    }
+
+    unsigned int file_bytes = file_buffer_bytes != 0 ? static_cast<unsigned int>(file_buffer_bytes) : DEFAULT_STREAM_FILE_BUFFER_BYTES;
+    FMOD_RESULT result = g_context->GetFmodSystem()->setStreamBufferSize(file_bytes, FMOD_TIMEUNIT_RAWBYTES);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to set stream buffer size: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+
+    BgmStreamSettings& settings = g_context->GetBgmStreamSettings();
+    settings.file_buffer_bytes = file_buffer_bytes;
+    settings.decode_buffer_ms = decode_buffer_ms;
+    return 0;
+}
+
+// Get the open and buffering state of a BGM stream
+int bgmGetStreamState(int slot, BgmStreamState* state) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    if (state == nullptr) {
+        g_context->SetLastError("Invalid parameter: state cannot be null");
+        return -1;
+    }
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
+        return -1;
+    }
+    if (!bgm->is_stream) {
+        g_context->SetLastError("BGM is not a stream: " + std::to_string(slot));
+        return -1;
+    }
+
+    FMOD_OPENSTATE open_state = FMOD_OPENSTATE_READY;
+    unsigned int percent_buffered = 0;
+    bool starving = false;
+    bool disk_busy = false;
+    FMOD_RESULT result = bgm->sound->getOpenState(&open_state, &percent_buffered, &starving, &disk_busy);
+    if (result != FMOD_OK && open_state != FMOD_OPENSTATE_ERROR) {
+        g_context->SetLastError(std::string("Failed to get BGM stream state: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+
+    // Count each starve once, however many calls see it
+    if (starving && !bgm->was_starving) {
+        bgm->starve_count++;
+    }
+    bgm->was_starving = starving;
+
+    state->open_state = static_cast<int>(open_state);
+    state->percent_buffered = static_cast<int>(percent_buffered);
+    state->starving = starving ? 1 : 0;
+    state->disk_busy = disk_busy ? 1 : 0;
+    state->starve_count = bgm->starve_count;
+    return 0;
+}
+
+// Pause BGM
+int bgmPause(int slot) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
+        return -1;
+    }
+
+    if (bgm->channel != nullptr) {
+        if (!pushChannelCommand(AUDIO_COMMAND_SET_CHANNEL_PAUSED, bgm->channel, true, 0.0f, 0)) {
             return -1;
         }
+        bgm->is_paused = true;
     }
     return 0;
 }
@@ -124,35 +461,35 @@ int bgmResume(int slot) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
-
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
+    if (!checkBgmReady(bgm)) {
+        return -1;
+    }
+    if (!checkBgmSlotOutsidePlaylist(slot)) {
         return -1;
     }
 
-    if (slots[slot].channel != nullptr) {
-        FMOD_RESULT result = slots[slot].channel->setPaused(false);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to resume BGM: ") + FMOD_ErrorString(result));
+    if (bgm->channel != nullptr) {
+        if (!pushChannelCommand(AUDIO_COMMAND_SET_CHANNEL_PAUSED, bgm->channel, false, 0.0f, 0)) {
             return -1;
         }
-    } else if (slots[slot].sound != nullptr) {
+        bgm->is_paused = false;
+    } else if (bgm->sound != nullptr) {
         // If channel doesn't exist, start playing
         FMOD::System* system = g_context->GetFmodSystem();
         FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
         FMOD::Channel* channel = nullptr;
 
-        FMOD_RESULT result = system->playSound(slots[slot].sound, bgmGroup, false, &channel);
+        FMOD_RESULT result = system->playSound(bgm->sound, bgmGroup, false, &channel);
         if (result != FMOD_OK) {
             g_context->SetLastError(std::string("Failed to play BGM: ") + FMOD_ErrorString(result));
             return -1;
         }
-        slots[slot].channel = channel;
+        bgm->channel = channel;
+        bgm->is_paused = false;
     }
     return 0;
 }
@@ -162,24 +499,17 @@ int bgmStop(int slot) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
 
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
-        return -1;
-    }
-
-    if (slots[slot].channel != nullptr) {
-        FMOD_RESULT result = slots[slot].channel->stop();
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to stop BGM: ") + FMOD_ErrorString(result));
+    if (bgm->channel != nullptr) {
+        if (!pushChannelCommand(AUDIO_COMMAND_STOP_CHANNEL, bgm->channel, false, 0.0f, 0)) {
             return -1;
         }
-        slots[slot].channel = nullptr;
+        bgm->channel = nullptr;
+        bgm->is_paused = false;
     }
     return 0;
 }
@@ -189,31 +519,16 @@ int bgmFadeout(int slot, int ms) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
 
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
-        return -1;
-    }
-
-    if (slots[slot].channel != nullptr) {
-        // Get current volume
-        float current_volume = 1.0f;
-        slots[slot].channel->getVolume(&current_volume);
-
-        // Set fade from current volume to 0
-        unsigned long long dspclock;
-        int rate;
-        g_context->GetFmodSystem()->getSoftwareFormat(&rate, nullptr, nullptr);
-        slots[slot].channel->getDSPClock(nullptr, &dspclock);
-
-        unsigned long long fade_length = (static_cast<unsigned long long>(ms) * rate) / 1000;
-        slots[slot].channel->addFadePoint(dspclock, current_volume);
-        slots[slot].channel->addFadePoint(dspclock + fade_length, 0.0f);
+    if (bgm->channel != nullptr) {
+        // Fade from current volume to 0 on the working thread
+        if (!pushChannelCommand(AUDIO_COMMAND_FADE_CHANNEL, bgm->channel, false, 0.0f, ms)) {
+            return -1;
+        }
     }
     return 0;
 }
@@ -223,29 +538,30 @@ int bgmFadein(int slot, int ms) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
-
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
+    if (!checkBgmReady(bgm)) {
+        return -1;
+    }
+    if (!checkBgmSlotOutsidePlaylist(slot)) {
         return -1;
     }
 
     FMOD::System* system = g_context->GetFmodSystem();
     FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
 
-    if (slots[slot].channel == nullptr && slots[slot].sound != nullptr) {
+    if (bgm->channel == nullptr && bgm->sound != nullptr) {
         // Start playing if not already playing
         FMOD::Channel* channel = nullptr;
-        FMOD_RESULT result = system->playSound(slots[slot].sound, bgmGroup, true, &channel);
+        FMOD_RESULT result = system->playSound(bgm->sound, bgmGroup, true, &channel);
         if (result != FMOD_OK) {
             g_context->SetLastError(std::string("Failed to play BGM: ") + FMOD_ErrorString(result));
             return -1;
         }
-        slots[slot].channel = channel;
+        bgm->channel = channel;
+        bgm->is_paused = false;
 
         if (channel != nullptr) {
             // Set up fade
@@ -261,19 +577,11 @@ int bgmFadein(int slot, int ms) {
             // Unpause to start playback
             channel->setPaused(false);
         }
-    } else if (slots[slot].channel != nullptr) {
-        // Already playing, just fade from current volume to 1.0
-        float current_volume = 0.0f;
-        slots[slot].channel->getVolume(&current_volume);
-
-        unsigned long long dspclock;
-        int rate;
-        system->getSoftwareFormat(&rate, nullptr, nullptr);
-        slots[slot].channel->getDSPClock(nullptr, &dspclock);
-
-        unsigned long long fade_length = (static_cast<unsigned long long>(ms) * rate) / 1000;
-        slots[slot].channel->addFadePoint(dspclock, current_volume);
-        slots[slot].channel->addFadePoint(dspclock + fade_length, 1.0f);
+    } else if (bgm->channel != nullptr) {
+        // Already playing, just fade from current volume to 1.0 on the working thread
+        if (!pushChannelCommand(AUDIO_COMMAND_FADE_CHANNEL, bgm->channel, false, 1.0f, ms)) {
+            return -1;
+        }
     }
     return 0;
 }
@@ -294,32 +602,29 @@ int bgmSetLoopPoint(int slot, int ms) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
-
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
+    if (!checkBgmReady(bgm)) {
         return -1;
     }
 
-    slots[slot].loop_point_ms = ms;
+    bgm->loop_point_ms = ms;
 
-    if (slots[slot].sound != nullptr) {
+    if (bgm->sound != nullptr) {
         // Convert milliseconds to PCM samples
         float frequency;
         int channels, bits;
-        slots[slot].sound->getDefaults(&frequency, nullptr);
-        slots[slot].sound->getFormat(nullptr, nullptr, &channels, &bits);
+        bgm->sound->getDefaults(&frequency, nullptr);
+        bgm->sound->getFormat(nullptr, nullptr, &channels, &bits);
 
         unsigned int loop_start = static_cast<unsigned int>((ms / 1000.0f) * frequency);
         unsigned int loop_end = 0;
-        slots[slot].sound->getLength(&loop_end, FMOD_TIMEUNIT_PCM);
+        bgm->sound->getLength(&loop_end, FMOD_TIMEUNIT_PCM);
 
         // Set loop points
-        FMOD_RESULT result = slots[slot].sound->setLoopPoints(loop_start, FMOD_TIMEUNIT_PCM, loop_end - 1, FMOD_TIMEUNIT_PCM);
+        FMOD_RESULT result = bgm->sound->setLoopPoints(loop_start, FMOD_TIMEUNIT_PCM, loop_end - 1, FMOD_TIMEUNIT_PCM);
         if (result != FMOD_OK) {
             g_context->SetLastError(std::string("Failed to set loop points: ") + FMOD_ErrorString(result));
             return -1;
@@ -328,31 +633,356 @@ int bgmSetLoopPoint(int slot, int ms) {
     return 0;
 }
 
+// Set the beat grid of a BGM for quantized transitions, bpm 0 clears it
+// first_beat_ms is the position of the first downbeat, bars are counted from it
+int bgmSetTempo(int slot, float bpm, int beats_per_bar, int first_beat_ms) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
+        return -1;
+    }
+
+    if (!(bpm >= 0.0f) || (bpm > 0.0f && beats_per_bar <= 0) || first_beat_ms < 0) {
+        g_context->SetLastError("Invalid parameters: bpm and first_beat_ms cannot be negative and beats_per_bar must be positive");
+        return -1;
+    }
+
+    bgm->bpm = bpm;
+    bgm->beats_per_bar = bpm > 0.0f ? beats_per_bar : 0;
+    bgm->first_beat_ms = bpm > 0.0f ? first_beat_ms : 0;
+    return 0;
+}
+
+// Add a transition marker (FMOD sync point) to a BGM
+int bgmAddMarker(int slot, int ms) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
+        return -1;
+    }
+    if (!checkBgmReady(bgm)) {
+        return -1;
+    }
+
+    if (ms < 0) {
+        g_context->SetLastError("Invalid parameter: ms cannot be negative");
+        return -1;
+    }
+
+    FMOD_RESULT result = bgm->sound->addSyncPoint(static_cast<unsigned int>(ms), FMOD_TIMEUNIT_MS, "marker", nullptr);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to add marker: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+    return 0;
+}
+
+// Remove every marker of a BGM, including the cue points read from the file
+int bgmClearMarkers(int slot) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
+        return -1;
+    }
+    if (!checkBgmReady(bgm)) {
+        return -1;
+    }
+
+    int count = 0;
+    bgm->sound->getNumSyncPoints(&count);
+    for (int i = count - 1; i >= 0; i--) {
+        FMOD_SYNCPOINT* point = nullptr;
+        if (bgm->sound->getSyncPoint(i, &point) == FMOD_OK) {
+            bgm->sound->deleteSyncPoint(point);
+        }
+    }
+    return 0;
+}
+
+// Frames from position to the first beat, bar or marker at or after it and before wrap, -1 if there is none
+// Positions are in the sound's frames
+static double boundaryAhead(const BgmSlot* bgm, int quantize, double frequency, double position, double wrap) {
+    if (quantize == BGM_QUANTIZE_MARKER) {
+        int count = 0;
+        bgm->sound->getNumSyncPoints(&count);
+        double nearest = -1.0;
+        for (int i = 0; i < count; i++) {
+            FMOD_SYNCPOINT* point = nullptr;
+            unsigned int offset = 0;
+            if (bgm->sound->getSyncPoint(i, &point) != FMOD_OK ||
+                bgm->sound->getSyncPointInfo(point, nullptr, 0, &offset, FMOD_TIMEUNIT_PCM) != FMOD_OK) {
+                continue;
+            }
+            double marker = static_cast<double>(offset);
+            if (marker >= position && marker < wrap && (nearest < 0.0 || marker < nearest)) {
+                nearest = marker;
+            }
+        }
+        return nearest < 0.0 ? -1.0 : nearest - position;
+    }
+
+    double unit = frequency * 60.0 / bgm->bpm;
+    if (quantize == BGM_QUANTIZE_BAR) {
+        unit *= bgm->beats_per_bar;
+    }
+    double first = static_cast<double>(bgm->first_beat_ms) * frequency / 1000.0;
+    // The small tolerance keeps a position right on a boundary from skipping to the next one
+    double boundary = first + std::ceil((position - first) / unit - 1e-6) * unit;
+    if (boundary >= wrap) {
+        return -1.0;
+    }
+    return boundary > position ? boundary - position : 0.0;
+}
+
+// BGM channel group DSP clock at which the playing BGM reaches its next beat, bar or marker,
+// at least a schedule lead from now, following its loop points
+// Returns false (sets the last error) on failure
+static bool getQuantizedClock(BgmSlot* bgm, int quantize, unsigned long long* clock) {
+    if (quantize < BGM_QUANTIZE_NONE || quantize > BGM_QUANTIZE_MARKER) {
+        g_context->SetLastError("Invalid quantize mode: " + std::to_string(quantize));
+        return false;
+    }
+    if ((quantize == BGM_QUANTIZE_BEAT || quantize == BGM_QUANTIZE_BAR) && bgm->bpm <= 0.0f) {
+        g_context->SetLastError("BGM has no tempo set");
+        return false;
+    }
+
+    // Pause and stop are queued for the working thread, so the slot's own state is checked rather than the channel's
+    bool playing = false;
+    if (bgm->channel == nullptr || bgm->channel->isPlaying(&playing) != FMOD_OK || !playing) {
+        g_context->SetLastError("BGM is not playing");
+        return false;
+    }
+    if (bgm->is_paused) {
+        g_context->SetLastError("BGM is paused");
+        return false;
+    }
+
+    if (quantize == BGM_QUANTIZE_NONE) {
+        return getBgmStartClock(clock);
+    }
+
+    FMOD::System* system = g_context->GetFmodSystem();
+    FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
+
+    // The position and the clock must come from the same mixer block, read again if a block was mixed in between
+    unsigned long long now = 0;
+    unsigned long long check = 0;
+    unsigned int position = 0;
+    FMOD_RESULT result = FMOD_OK;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        result = bgmGroup->getDSPClock(&now, nullptr);
+        if (result == FMOD_OK) {
+            result = bgm->channel->getPosition(&position, FMOD_TIMEUNIT_PCM);
+        }
+        if (result == FMOD_OK) {
+            result = bgmGroup->getDSPClock(&check, nullptr);
+        }
+        if (result != FMOD_OK || now == check) {
+            break;
+        }
+    }
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to get BGM position: ") + FMOD_ErrorString(result));
+        return false;
+    }
+
+    // A channel scheduled to start later (a transition still pending) holds its position until then
+    unsigned long long delay_start = 0;
+    bgm->channel->getDelay(&delay_start, nullptr);
+    unsigned long long origin = delay_start > now ? delay_start : now;
+
+    float sound_frequency = 0.0f;
+    float channel_frequency = 0.0f;
+    float pitch = 1.0f;
+    unsigned int loop_start = 0;
+    unsigned int loop_end = 0;
+    int mixer_rate = 0;
+    bgm->sound->getDefaults(&sound_frequency, nullptr);
+    bgm->channel->getFrequency(&channel_frequency);
+    bgm->channel->getPitch(&pitch);
+    bgm->channel->getLoopPoints(&loop_start, FMOD_TIMEUNIT_PCM, &loop_end, FMOD_TIMEUNIT_PCM);
+    system->getSoftwareFormat(&mixer_rate, nullptr, nullptr);
+    double speed = static_cast<double>(channel_frequency) * pitch;
+    if (sound_frequency <= 0.0f || speed <= 0.0 || loop_end < loop_start) {
+        g_context->SetLastError("BGM is not advancing");
+        return false;
+    }
+
+    // Positions are in the sound's frames, clocks at the mixer rate
+    double ratio = static_cast<double>(mixer_rate) / speed;
+    double wrap = static_cast<double>(loop_end) + 1.0;
+    double period = wrap - loop_start;
+
+    // Where the BGM is at the earliest clock the transition can still be scheduled for
+    unsigned long long min_clock = now + getBgmScheduleLead(system);
+    double traveled = min_clock > origin ? static_cast<double>(min_clock - origin) / ratio : 0.0;
+    double from = static_cast<double>(position) + traveled;
+    if (from >= wrap) {
+        from = loop_start + std::fmod(from - wrap, period);
+    }
+
+    // The rest of this pass, then the loop once more (a marker before the loop start is never reached again)
+    double ahead = boundaryAhead(bgm, quantize, sound_frequency, from, wrap);
+    if (ahead < 0.0) {
+        double next = boundaryAhead(bgm, quantize, sound_frequency, loop_start, wrap);
+        if (next < 0.0) {
+            g_context->SetLastError(quantize == BGM_QUANTIZE_MARKER ? "BGM has no marker ahead" : "BGM loop is shorter than the quantize unit");
+            return false;
+        }
+        ahead = (wrap - from) + next;
+    }
+
+    unsigned long long target = origin + static_cast<unsigned long long>(std::llround((traveled + ahead) * ratio));
+    *clock = target > min_clock ? target : min_clock;
+    return true;
+}
+
+// Get the DSP clock of the next beat, bar or marker of a playing BGM
+// Same clock as coreGetDSPClock, so oneshots can be scheduled on it
+int bgmGetQuantizedClock(int slot, int quantize, unsigned long long* clock) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    if (clock == nullptr) {
+        g_context->SetLastError("Invalid parameter: clock cannot be null");
+        return -1;
+    }
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
+        return -1;
+    }
+
+    if (!getQuantizedClock(bgm, quantize, clock)) {
+        return -1;
+    }
+    return 0;
+}
+
+// Crossfade from the playing slot1 to slot2, both starting on slot1's next beat, bar or marker
+// slot2 starts from its first downbeat when it has a tempo set, slot1 fades to 0 and keeps playing like bgmCrossfade
+int bgmCrossfadeQuantized(int slot1, int slot2, int ms, int quantize) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    if (ms < 0) {
+        g_context->SetLastError("Invalid parameter: ms cannot be negative");
+        return -1;
+    }
+    BgmSlot* from = resolveBgmSlot(slot1);
+    if (from == nullptr) {
+        return -1;
+    }
+    BgmSlot* to = resolveBgmSlot(slot2);
+    if (to == nullptr) {
+        return -1;
+    }
+    if (from == to) {
+        g_context->SetLastError("Cannot crossfade a BGM into itself");
+        return -1;
+    }
+    if (!checkBgmReady(to)) {
+        return -1;
+    }
+    if (!checkBgmSlotOutsidePlaylist(slot2)) {
+        return -1;
+    }
+    if (to->sound == nullptr) {
+        g_context->SetLastError("Sound is not loaded");
+        return -1;
+    }
+
+    unsigned long long start = 0;
+    if (!getQuantizedClock(from, quantize, &start)) {
+        return -1;
+    }
+
+    FMOD::System* system = g_context->GetFmodSystem();
+    FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
+    int rate = 0;
+    system->getSoftwareFormat(&rate, nullptr, nullptr);
+    unsigned long long fade_length = (static_cast<unsigned long long>(ms) * rate) / 1000;
+    if (fade_length == 0) {
+        fade_length = 1;
+    }
+
+    // Stop existing channel if playing
+    if (to->channel != nullptr) {
+        to->channel->stop();
+        to->channel = nullptr;
+    }
+
+    // The incoming BGM is held paused until it is scheduled, then waits for the boundary
+    FMOD::Channel* channel = nullptr;
+    FMOD_RESULT result = system->playSound(to->sound, bgmGroup, true, &channel);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to play BGM: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+    if (to->bpm > 0.0f && to->first_beat_ms > 0) {
+        result = channel->setPosition(static_cast<unsigned int>(to->first_beat_ms), FMOD_TIMEUNIT_MS);
+    }
+    if (result == FMOD_OK) {
+        result = channel->setDelay(start, 0, true);
+    }
+    if (result != FMOD_OK) {
+        channel->stop();
+        g_context->SetLastError(std::string("Failed to schedule BGM: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+    channel->addFadePoint(start, 0.0f);
+    channel->addFadePoint(start + fade_length, 1.0f);
+
+    // The outgoing BGM keeps its volume until the boundary, replacing any ramp planned past it
+    float volume = 1.0f;
+    from->channel->getVolume(&volume);
+    from->channel->removeFadePoints(start, ULLONG_MAX);
+    from->channel->addFadePoint(start, volume);
+    from->channel->addFadePoint(start + fade_length, 0.0f);
+
+    result = channel->setPaused(false);
+    if (result != FMOD_OK) {
+        channel->stop();
+        g_context->SetLastError(std::string("Failed to unpause BGM: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+
+    to->channel = channel;
+    to->is_paused = false;
+    return 0;
+}
+
 // Play BGM (resets position to 0)
 int bgmPlay(int slot) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
-
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
+    if (!checkBgmReady(bgm)) {
+        return -1;
+    }
+    if (!checkBgmSlotOutsidePlaylist(slot)) {
         return -1;
     }
 
-    if (slots[slot].sound == nullptr) {
+    if (bgm->sound == nullptr) {
         g_context->SetLastError("Sound is not loaded");
         return -1;
     }
 
     // Stop existing channel if playing
-    if (slots[slot].channel != nullptr) {
-        slots[slot].channel->stop();
-        slots[slot].channel = nullptr;
+    if (bgm->channel != nullptr) {
+        bgm->channel->stop();
+        bgm->channel = nullptr;
     }
 
     FMOD::System* system = g_context->GetFmodSystem();
@@ -360,7 +990,7 @@ int bgmPlay(int slot) {
     FMOD::Channel* channel = nullptr;
 
     // Start paused to reset position
-    FMOD_RESULT result = system->playSound(slots[slot].sound, bgmGroup, true, &channel);
+    FMOD_RESULT result = system->playSound(bgm->sound, bgmGroup, true, &channel);
     if (result != FMOD_OK) {
         g_context->SetLastError(std::string("Failed to play BGM: ") + FMOD_ErrorString(result));
         return -1;
@@ -380,46 +1010,71 @@ int bgmPlay(int slot) {
         return -1;
     }
 
-    slots[slot].channel = channel;
+    bgm->channel = channel;
+    bgm->is_paused = false;
     return 0;
 }
 
+// Release the sound of a slot and what it reads from (mapped file, copied buffer)
+static void releaseBgmSlot(BgmSlot* bgm) {
+    if (bgm->sound != nullptr) {
+        bgm->sound->release();
+        bgm->sound = nullptr;
+        if (bgm->is_stream) {
+            noteStreamClosed();
+        }
+    }
+
+    // Unmap the file only after the stream reading it is released
+    unmapFile(&bgm->mapped);
+
+    // Free buffer
+    if (bgm->buffer != nullptr) {
+        poolFree(bgm->buffer);
+        bgm->buffer = nullptr;
+    }
+}
+
 // Free BGM slot
 int bgmFree(int slot) {
     if (!isBackendInitialized()) {
         return -1;
     }
-    if (slot < 0) {
-        g_context->SetLastError("Invalid slot number");
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr) {
         return -1;
     }
 
-    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
-    if (slot >= static_cast<int>(slots.size()) || !slots[slot].is_used) {
-        g_context->SetLastError("Slot is not in use");
-        return -1;
-    }
+    // Playlists must let go of the sound before it is released
+    removeBgmPlaylistSlot(slot);
 
     // Stop and release channel
-    if (slots[slot].channel != nullptr) {
-        slots[slot].channel->stop();
-        slots[slot].channel = nullptr;
+    if (bgm->channel != nullptr) {
+        bgm->channel->stop();
+        bgm->channel = nullptr;
     }
+    releaseBgmSlot(bgm);
 
-    // Release sound
-    if (slots[slot].sound != nullptr) {
-        slots[slot].sound->release();
-        slots[slot].sound = nullptr;
-    }
+    // Return the slot to the free list, keeping the generation so the handle stays invalid
+    unsigned int generation = bgm->generation;
+    *bgm = BgmSlot();
+    bgm->generation = generation;
+    g_context->GetBgmFreeSlots().push_back(slot & BGM_HANDLE_INDEX_MASK);
+    return 0;
+}
 
-    // Free buffer
-    if (slots[slot].buffer != nullptr) {
-        free(slots[slot].buffer);
-        slots[slot].buffer = nullptr;
+// Release every BGM slot still loaded, for coreFree
+// The sounds have to go before the system is closed, the buffers before the arena is shut down,
+// and the mapped files so they aren't left locked
+void bgmShutdown() {
+    std::vector<BgmSlot>& slots = g_context->GetBgmSlots();
+    for (size_t i = 0; i < slots.size(); i++) {
+        BgmSlot& bgm = slots[i];
+        if (!bgm.is_used) {
+            continue;
+        }
+        releaseBgmSlot(&bgm);
+        bgm = BgmSlot();
     }
-
-    // Mark slot as unused
-    slots[slot].is_used = false;
-    slots[slot].loop_point_ms = -1;
-    return 0;
+    g_context->GetBgmFreeSlots().clear();
 }
@@ -1,8 +1,54 @@
 #ifndef BGM_H
 #define BGM_H
 
+#include "fmod/fmod.hpp"
+
+// BGM handle: bits 0-15 slot index, bits 16-29 generation (bumped on every reuse of the slot)
+const int BGM_HANDLE_INDEX_BITS = 16;
+const int BGM_HANDLE_INDEX_MASK = (1 << BGM_HANDLE_INDEX_BITS) - 1;
+const int BGM_HANDLE_GENERATION_MASK = (1 << 14) - 1;
+// Music group handles use the same layout with bit 30 set, so they never resolve as a BGM handle
+const int MUSIC_GROUP_HANDLE_BIT = 1 << 30;
+
+// Where a quantized transition starts (bgmCrossfadeQuantized)
+const int BGM_QUANTIZE_NONE = 0;  // A few mixer blocks from now
+const int BGM_QUANTIZE_BEAT = 1;
+const int BGM_QUANTIZE_BAR = 2;
+const int BGM_QUANTIZE_MARKER = 3;  // Next sync point of the sound (file cue points or bgmAddMarker)
+
+struct BgmSlot;
+
+// Slot of a live BGM handle, or null (sets the last error)
+BgmSlot* resolveBgmSlot(int handle);
+
+// Check that a bgmOpenStream stream has finished opening (always true for the other loads)
+// Returns false (sets the last error) while it is still opening or if it failed to open
+bool checkBgmReady(BgmSlot* bgm);
+
+// Mixer blocks (in DSP clocks) between scheduling a channel and its start
+unsigned long long getBgmScheduleLead(FMOD::System* system);
+
+// BGM channel group DSP clock a few mixer blocks from now, for Channel::setDelay
+// Returns false (sets the last error) on failure
+bool getBgmStartClock(unsigned long long* clock);
+
 int globalSetBgmVolume(float volume);
 int bgmLoad(const void* address, int size);
+int bgmLoadPoint(const void* address, int size);
+int bgmLoadFile(const char* path);
+int bgmOpenStream(const char* path);
+int bgmSetStreamBufferSize(int file_buffer_bytes, int decode_buffer_ms);
+
+// Open and buffering state of a BGM stream (Sound::getOpenState)
+struct BgmStreamState {
+    int open_state;  // FMOD_OPENSTATE
+    int percent_buffered;  // Stream file buffer fill
+    int starving;  // 1 while the file can't be read fast enough for playback
+    int disk_busy;  // 1 while the file is being read
+    int starve_count;  // Starves seen by bgmGetStreamState since the stream was opened
+};
+
+int bgmGetStreamState(int slot, BgmStreamState* state);
 int bgmPause(int slot);
 int bgmResume(int slot);
 int bgmStop(int slot);
@@ -10,7 +56,15 @@ int bgmFadeout(int slot, int ms);
 int bgmFadein(int slot, int ms);
 int bgmCrossfade(int slot1, int slot2, int ms);
 int bgmSetLoopPoint(int slot, int ms);
+int bgmSetTempo(int slot, float bpm, int beats_per_bar, int first_beat_ms);
+int bgmAddMarker(int slot, int ms);
+int bgmClearMarkers(int slot);
+int bgmGetQuantizedClock(int slot, int quantize, unsigned long long* clock);
+int bgmCrossfadeQuantized(int slot1, int slot2, int ms, int quantize);
 int bgmPlay(int slot);
 int bgmFree(int slot);
 
+// Release every loaded BGM slot, called by coreFree before the system is closed
+void bgmShutdown();
+
 #endif // BGM_H
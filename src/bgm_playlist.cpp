@@ -0,0 +1,400 @@
+#include "bgm_playlist.h"
+#include "bgm.h"
+#include "context.h"
+#include "fmod/fmod.hpp"
+#include "fmod/fmod_errors.h"
+#include <cmath>
+#include <string>
+#include <vector>
+#include <Windows.h>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+// The next segment's channel is started this long before the hand-over, so its stream is buffered by then
+static const int PREBUFFER_MS = 1000;
+
+// Playlist index of a live handle, or -1 (sets the last error); the lock must be held
+static int getPlaylistIndex(int handle) {
+    auto& playlists = g_context->GetBgmPlaylists();
+    size_t index = static_cast<size_t>(handle & BGM_HANDLE_INDEX_MASK);
+    unsigned int generation = static_cast<unsigned int>(handle >> BGM_HANDLE_INDEX_BITS) & BGM_HANDLE_GENERATION_MASK;
+    if (handle <= 0 || index >= playlists.size() || !playlists[index].is_used || playlists[index].generation != generation) {
+        g_context->SetLastError("Invalid BGM playlist handle: " + std::to_string(handle));
+        return -1;
+    }
+    return static_cast<int>(index);
+}
+
+static void stopPlaylist(BgmPlaylist& playlist) {
+    if (playlist.channel != nullptr) {
+        playlist.channel->stop();
+    }
+    if (playlist.next_channel != nullptr) {
+        playlist.next_channel->stop();
+    }
+    playlist.current = -1;
+    playlist.channel = nullptr;
+    playlist.next_channel = nullptr;
+    playlist.start_clock = 0;
+    playlist.end_clock = 0;
+    playlist.next_start_clock = 0;
+}
+
+// Start a segment's sound held by setDelay until start_clock, null on failure
+static FMOD::Channel* startSegment(FMOD::System* system, FMOD::Sound* sound, unsigned long long start_clock, FMOD_RESULT* result) {
+    FMOD::Channel* channel = nullptr;
+    *result = system->playSound(sound, g_context->GetBgmChannelGroup(), true, &channel);
+    if (*result == FMOD_OK) {
+        *result = channel->setDelay(start_clock, 0, true);
+    }
+    if (*result == FMOD_OK) {
+        *result = channel->setPaused(false);
+    }
+    if (*result != FMOD_OK) {
+        if (channel != nullptr) {
+            channel->stop();
+        }
+        return nullptr;
+    }
+    return channel;
+}
+
+// First clock at or after min_clock at which a segment started at start_clock reaches its
+// hand-over position (the end marker, or the loop end), following the slot's loop points
+static unsigned long long segmentEndClock(const PlaylistSegment& segment, unsigned long long start_clock, unsigned long long min_clock, int mixer_rate) {
+    float frequency = 0.0f;
+    unsigned int loop_start = 0;
+    unsigned int loop_end = 0;
+    segment.sound->getDefaults(&frequency, nullptr);
+    segment.sound->getLoopPoints(&loop_start, FMOD_TIMEUNIT_PCM, &loop_end, FMOD_TIMEUNIT_PCM);
+    if (frequency <= 0.0f || loop_end < loop_start) {
+        return min_clock;
+    }
+
+    // Positions are in the slot's frames, clocks at the mixer rate
+    double ratio = static_cast<double>(mixer_rate) / frequency;
+    double wrap = static_cast<double>(loop_end) + 1.0;
+    double target = wrap;
+    if (segment.end_ms >= 0) {
+        double marker = std::floor(static_cast<double>(segment.end_ms) * frequency / 1000.0);
+        if (marker < wrap) {
+            target = marker;
+        }
+    }
+
+    // First pass, from the start of the slot
+    unsigned long long first = start_clock + static_cast<unsigned long long>(std::llround(target * ratio));
+    if (first >= min_clock) {
+        return first;
+    }
+
+    // Later passes only cover the loop, a marker before it is never reached again
+    if (target < loop_start) {
+        target = wrap;
+    }
+    double period = wrap - loop_start;
+    double base = wrap + (target - loop_start);  // Frames until pass 1 reaches the target
+    double needed = static_cast<double>(min_clock - start_clock) / ratio;
+    long long pass = needed <= base ? 1 : static_cast<long long>(std::ceil((needed - base) / period)) + 1;
+    while (true) {
+        unsigned long long clock = start_clock + static_cast<unsigned long long>(std::llround((base + (pass - 1) * period) * ratio));
+        if (clock >= min_clock) {
+            return clock;
+        }
+        pass++;
+    }
+}
+
+// Hand over to the next segment once it has started, then schedule the one after
+// The lock must be held; errors are dropped, the next update tries again
+static void advancePlaylist(BgmPlaylist& playlist, FMOD::System* system, unsigned long long now, unsigned long long lead, unsigned long long prebuffer, int mixer_rate) {
+    if (playlist.next_channel != nullptr && now >= playlist.next_start_clock) {
+        playlist.current++;
+        playlist.channel = playlist.next_channel;
+        playlist.start_clock = playlist.next_start_clock;
+        playlist.end_clock = 0;
+        playlist.next_channel = nullptr;
+    }
+
+    // The last segment loops until another one is appended
+    if (playlist.current + 1 >= static_cast<int>(playlist.segments.size())) {
+        return;
+    }
+
+    // Fix the hand-over a few blocks ahead at least, so the stop is in place before the mixer gets there
+    if (playlist.end_clock == 0) {
+        playlist.end_clock = segmentEndClock(playlist.segments[playlist.current], playlist.start_clock, now + lead, mixer_rate);
+        playlist.channel->setDelay(playlist.start_clock, playlist.end_clock, true);
+    }
+
+    // Start the next segment early, held until the hand-over, so its stream is buffered in time
+    if (playlist.next_channel == nullptr && playlist.end_clock <= now + prebuffer) {
+        // Late (the hand-over passed before it could start): start as soon as possible
+        unsigned long long start = playlist.end_clock > now + lead ? playlist.end_clock : now + lead;
+        FMOD_RESULT result;
+        playlist.next_channel = startSegment(system, playlist.segments[playlist.current + 1].sound, start, &result);
+        playlist.next_start_clock = start;
+    }
+}
+
+int bgmPlaylistCreate() {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    int index = -1;
+    for (size_t i = 0; i < playlists.size(); i++) {
+        if (!playlists[i].is_used) {
+            index = static_cast<int>(i);
+            break;
+        }
+    }
+    if (index < 0) {
+        if (playlists.size() > static_cast<size_t>(BGM_HANDLE_INDEX_MASK)) {
+            ReleaseSRWLockExclusive(lock);
+            g_context->SetLastError("Too many BGM playlists");
+            return -1;
+        }
+        playlists.push_back(BgmPlaylist());
+        index = static_cast<int>(playlists.size() - 1);
+    }
+
+    BgmPlaylist& playlist = playlists[index];
+    unsigned int generation = (playlist.generation % BGM_HANDLE_GENERATION_MASK) + 1;
+    playlist = BgmPlaylist();
+    playlist.generation = generation;
+    playlist.is_used = true;
+    ReleaseSRWLockExclusive(lock);
+
+    return static_cast<int>(generation << BGM_HANDLE_INDEX_BITS) | index;
+}
+
+int bgmPlaylistFree(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    int index = getPlaylistIndex(handle);
+    if (index >= 0) {
+        BgmPlaylist& playlist = playlists[index];
+        stopPlaylist(playlist);
+        unsigned int generation = playlist.generation;
+        playlist = BgmPlaylist();
+        playlist.generation = generation;
+    }
+    ReleaseSRWLockExclusive(lock);
+    return index >= 0 ? 0 : -1;
+}
+
+int bgmPlaylistAppend(int handle, int slot, int end_ms) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (end_ms < -1) {
+        g_context->SetLastError("Invalid end marker: " + std::to_string(end_ms));
+        return -1;
+    }
+
+    // The stream must be open already, the hand-over can't wait for it
+    BgmSlot* bgm = resolveBgmSlot(slot);
+    if (bgm == nullptr || !checkBgmReady(bgm)) {
+        return -1;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    int index = getPlaylistIndex(handle);
+    bool ok = index >= 0;
+    if (ok) {
+        BgmPlaylist& playlist = playlists[index];
+        // A stream has one channel, so the same slot can't overlap itself at the hand-over
+        if (!playlist.segments.empty() && playlist.segments.back().slot == slot) {
+            g_context->SetLastError("BGM handle can't follow itself in a playlist: " + std::to_string(slot));
+            ok = false;
+        } else {
+            PlaylistSegment segment;
+            segment.slot = slot;
+            segment.sound = bgm->sound;
+            segment.end_ms = end_ms;
+            playlist.segments.push_back(segment);
+        }
+    }
+    ReleaseSRWLockExclusive(lock);
+    return ok ? 0 : -1;
+}
+
+int bgmPlaylistPlay(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    int index = getPlaylistIndex(handle);
+    bool ok = index >= 0;
+    if (ok && playlists[index].segments.empty()) {
+        g_context->SetLastError("BGM playlist is empty");
+        ok = false;
+    }
+
+    unsigned long long start_clock = 0;
+    if (ok) {
+        stopPlaylist(playlists[index]);
+        ok = getBgmStartClock(&start_clock);
+    }
+    if (ok) {
+        BgmPlaylist& playlist = playlists[index];
+        FMOD_RESULT result;
+        playlist.channel = startSegment(g_context->GetFmodSystem(), playlist.segments[0].sound, start_clock, &result);
+        if (playlist.channel == nullptr) {
+            g_context->SetLastError(std::string("Failed to play BGM playlist: ") + FMOD_ErrorString(result));
+            ok = false;
+        } else {
+            playlist.current = 0;
+            playlist.start_clock = start_clock;
+        }
+    }
+    ReleaseSRWLockExclusive(lock);
+    return ok ? 0 : -1;
+}
+
+int bgmPlaylistStop(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    int index = getPlaylistIndex(handle);
+    if (index >= 0) {
+        stopPlaylist(playlists[index]);
+    }
+    ReleaseSRWLockExclusive(lock);
+    return index >= 0 ? 0 : -1;
+}
+
+int bgmPlaylistGetSegment(int handle, int* segment) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (segment == nullptr) {
+        g_context->SetLastError("Invalid parameter: segment cannot be null");
+        return -1;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockShared(lock);
+    int index = getPlaylistIndex(handle);
+    if (index >= 0) {
+        *segment = playlists[index].current;
+    }
+    ReleaseSRWLockShared(lock);
+    return index >= 0 ? 0 : -1;
+}
+
+void updateBgmPlaylists(FMOD::System* system) {
+    FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
+    if (bgmGroup == nullptr) {
+        return;
+    }
+
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    unsigned long long now = 0;
+    if (!playlists.empty() && bgmGroup->getDSPClock(&now, nullptr) == FMOD_OK) {
+        int rate = 0;
+        system->getSoftwareFormat(&rate, nullptr, nullptr);
+        unsigned long long lead = getBgmScheduleLead(system);
+        unsigned long long prebuffer = static_cast<unsigned long long>(PREBUFFER_MS) * rate / 1000;
+        for (BgmPlaylist& playlist : playlists) {
+            if (playlist.is_used && playlist.current >= 0) {
+                advancePlaylist(playlist, system, now, lead, prebuffer, rate);
+            }
+        }
+    }
+    ReleaseSRWLockExclusive(lock);
+}
+
+bool checkBgmSlotOutsidePlaylist(int slot) {
+    bool in_playlist = false;
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockShared(lock);
+    for (const BgmPlaylist& playlist : playlists) {
+        if (!playlist.is_used || playlist.current < 0) {
+            continue;
+        }
+        for (const PlaylistSegment& segment : playlist.segments) {
+            if (segment.slot == slot) {
+                in_playlist = true;
+                break;
+            }
+        }
+        if (in_playlist) {
+            break;
+        }
+    }
+    ReleaseSRWLockShared(lock);
+
+    if (in_playlist) {
+        g_context->SetLastError("BGM is a segment of a playing playlist: " + std::to_string(slot));
+        return false;
+    }
+    return true;
+}
+
+void removeBgmPlaylistSlot(int slot) {
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    for (BgmPlaylist& playlist : playlists) {
+        if (!playlist.is_used) {
+            continue;
+        }
+        bool found = false;
+        for (size_t i = 0; i < playlist.segments.size();) {
+            if (playlist.segments[i].slot == slot) {
+                playlist.segments.erase(playlist.segments.begin() + i);
+                found = true;
+            } else {
+                i++;
+            }
+        }
+        if (!found) {
+            continue;
+        }
+        // The segments around it may now be the same slot twice in a row
+        for (size_t i = 1; i < playlist.segments.size();) {
+            if (playlist.segments[i].slot == playlist.segments[i - 1].slot) {
+                playlist.segments.erase(playlist.segments.begin() + i);
+            } else {
+                i++;
+            }
+        }
+        // Segment indices moved, so a playing playlist can't continue
+        stopPlaylist(playlist);
+    }
+    ReleaseSRWLockExclusive(lock);
+}
+
+void bgmPlaylistShutdown() {
+    SRWLOCK* lock = g_context->GetBgmPlaylistLock();
+    auto& playlists = g_context->GetBgmPlaylists();
+    AcquireSRWLockExclusive(lock);
+    std::vector<BgmPlaylist>().swap(playlists);
+    ReleaseSRWLockExclusive(lock);
+}
@@ -0,0 +1,38 @@
+#ifndef BGM_PLAYLIST_H
+#define BGM_PLAYLIST_H
+
+#include "fmod/fmod.hpp"
+
+// Playlists chain BGM slots (segments) back to back on the DSP clock
+// Handles: bits 0-15 playlist index, bits 16-29 generation (the BGM handle layout)
+// Every segment but the last plays once, to its end or its end marker; the last one loops
+
+// Returns the playlist handle (> 0), or -1 on failure
+int bgmPlaylistCreate();
+int bgmPlaylistFree(int playlist);
+
+// Add a segment, end_ms is the marker it hands over at (-1 for the end of the slot)
+// Can be called while the playlist plays, the looping last segment then hands over at its next loop end
+int bgmPlaylistAppend(int playlist, int slot, int end_ms);
+
+int bgmPlaylistPlay(int playlist);
+int bgmPlaylistStop(int playlist);
+
+// Index of the segment playing, -1 when stopped
+int bgmPlaylistGetSegment(int playlist, int* segment);
+
+// Schedule the next segments, called after each update by the thread that drives the mixer
+void updateBgmPlaylists(FMOD::System* system);
+
+// Check that a slot is not a segment of a playing playlist, before it is started outside of it
+// A stream has a single channel, so starting it again would take the channel from under the playlist
+// Returns false (sets the last error) if it is
+bool checkBgmSlotOutsidePlaylist(int slot);
+
+// Stop and drop the segments of a slot that is being freed
+void removeBgmPlaylistSlot(int slot);
+
+// Forget every playlist, before the FMOD system is released
+void bgmPlaylistShutdown();
+
+#endif // BGM_PLAYLIST_H
@@ -0,0 +1,135 @@
+#include "command_queue.h"
+#include <cstdint>
+#include "fmod/fmod_dsp.h"
+
+CommandQueue::CommandQueue(size_t capacity) : mask(0), enqueue_pos(0), dequeue_pos(0) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    cells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask = size - 1;
+}
+
+bool CommandQueue::push(const AudioCommand& command) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // Cell is free, try to claim it
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer has not released this cell yet, queue is full
+            return false;
+        } else {
+            // Another producer claimed it, reload position
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->command = command;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandQueue::pop(AudioCommand& command) {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    Cell* cell = &cells[pos & mask];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+        // Producer has not published this cell yet
+        return false;
+    }
+    command = cell->command;
+    dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandQueue::empty() const {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+    return static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0;
+}
+
+// Fade a channel from its current volume to target over fade_ms
+static void fadeChannel(FMOD::System* system, FMOD::Channel* channel, float target_volume, int fade_ms) {
+    float current_volume = 1.0f;
+    if (channel->getVolume(&current_volume) != FMOD_OK) {
+        return;
+    }
+
+    unsigned long long dspclock;
+    int rate;
+    system->getSoftwareFormat(&rate, nullptr, nullptr);
+    channel->getDSPClock(nullptr, &dspclock);
+
+    unsigned long long fade_length = (static_cast<unsigned long long>(fade_ms) * rate) / 1000;
+    channel->addFadePoint(dspclock, current_volume);
+    channel->addFadePoint(dspclock + fade_length, target_volume);
+}
+
+// Apply a single command. FMOD errors are ignored here because the
+// caller has already returned; they are almost always stale channel handles.
+static void applyCommand(const AudioCommand& command, FMOD::System* system) {
+    switch (command.type) {
+    case AUDIO_COMMAND_SET_LISTENER_ATTRIBUTES:
+        system->set3DListenerAttributes(0, &command.listener.pos, &command.listener.vel, &command.listener.forward, &command.listener.up);
+        break;
+
+    case AUDIO_COMMAND_SET_SOURCE_POSITION: {
+        FMOD_VECTOR vel = { 0.0f, 0.0f, 0.0f };
+        FMOD_DSP_PARAMETER_3DATTRIBUTES dsp_3d_attrs = {};
+        dsp_3d_attrs.relative.position = command.source.position;
+        dsp_3d_attrs.relative.velocity = vel;
+        dsp_3d_attrs.relative.forward = { 0.0f, 0.0f, 1.0f };
+        dsp_3d_attrs.relative.up = { 0.0f, 1.0f, 0.0f };
+        dsp_3d_attrs.absolute.position = command.source.position;
+        dsp_3d_attrs.absolute.velocity = vel;
+        dsp_3d_attrs.absolute.forward = { 0.0f, 0.0f, 1.0f };
+        dsp_3d_attrs.absolute.up = { 0.0f, 1.0f, 0.0f };
+        command.source.dsp->setParameterData(8, &dsp_3d_attrs, sizeof(dsp_3d_attrs));
+        break;
+    }
+
+    case AUDIO_COMMAND_SET_GROUP_VOLUME:
+        command.group.group->setVolume(command.group.volume);
+        break;
+
+    case AUDIO_COMMAND_RELEASE_GROUP:
+        if (command.group.channel != nullptr) {
+            command.group.channel->stop();
+        }
+        command.group.group->release();
+        break;
+
+    case AUDIO_COMMAND_SET_CHANNEL_PAUSED:
+        command.channel.channel->setPaused(command.channel.paused);
+        break;
+
+    case AUDIO_COMMAND_STOP_CHANNEL:
+        command.channel.channel->stop();
+        break;
+
+    case AUDIO_COMMAND_FADE_CHANNEL:
+        fadeChannel(system, command.channel.channel, command.channel.target_volume, command.channel.fade_ms);
+        break;
+    }
+}
+
+int drainCommandQueue(CommandQueue& queue, FMOD::System* system) {
+    int applied = 0;
+    AudioCommand command;
+    while (queue.pop(command)) {
+        applyCommand(command, system);
+        applied++;
+    }
+    return applied;
+}
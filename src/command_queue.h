@@ -0,0 +1,95 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include "fmod/fmod.hpp"
+
+// Types of commands that API calls hand over to the working thread
+enum AudioCommandType {
+    AUDIO_COMMAND_SET_LISTENER_ATTRIBUTES,
+    AUDIO_COMMAND_SET_SOURCE_POSITION,
+    AUDIO_COMMAND_SET_GROUP_VOLUME,
+    AUDIO_COMMAND_RELEASE_GROUP,
+    AUDIO_COMMAND_SET_CHANNEL_PAUSED,
+    AUDIO_COMMAND_STOP_CHANNEL,
+    AUDIO_COMMAND_FADE_CHANNEL,
+};
+
+struct ListenerCommand {
+    FMOD_VECTOR pos;
+    FMOD_VECTOR vel;
+    FMOD_VECTOR forward;
+    FMOD_VECTOR up;
+};
+
+struct SourcePositionCommand {
+    FMOD::DSP* dsp;  // Resonance Audio Source DSP
+    FMOD_VECTOR position;
+};
+
+struct GroupCommand {
+    FMOD::ChannelGroup* group;
+    FMOD::Channel* channel;  // Stopped before the group is released, can be null
+    float volume;
+};
+
+struct ChannelCommand {
+    FMOD::Channel* channel;
+    bool paused;
+    float target_volume;  // Fade target volume
+    int fade_ms;
+};
+
+// Small fixed-size command, copied by value into the queue
+struct AudioCommand {
+    AudioCommandType type;
+    union {
+        ListenerCommand listener;
+        SourcePositionCommand source;
+        GroupCommand group;
+        ChannelCommand channel;
+    };
+};
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+// Any thread may push, only the working thread pops.
+class CommandQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        AudioCommand command;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // Padding keeps producer and consumer positions on separate cache lines
+    char pad0[64];
+    std::atomic<size_t> enqueue_pos;
+    char pad1[64];
+    std::atomic<size_t> dequeue_pos;
+    char pad2[64];
+
+public:
+    // capacity is rounded up to a power of two
+    explicit CommandQueue(size_t capacity);
+
+    // Returns false if the queue is full
+    bool push(const AudioCommand& command);
+
+    // Returns false if the queue is empty
+    bool pop(AudioCommand& command);
+
+    bool empty() const;
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+};
+
+// Apply every queued command to FMOD in one batch.
+// Must be called from the thread that owns the queue consumer side.
+// Returns the number of commands applied.
+int drainCommandQueue(CommandQueue& queue, FMOD::System* system);
+
+#endif // COMMAND_QUEUE_H
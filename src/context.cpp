@@ -1,4 +1,5 @@
 #include "context.h"
+#include "working_thread.h"
 
 // Global context variable (pointer)
 // Not null when backend is initialized
@@ -9,10 +10,7 @@ bool isBackendInitialized() {
     return g_context != nullptr && g_context->isBackendInitialized();
 }
 
-AudioBackendContext::AudioBackendContext() : last_error(""), backend_initialized(false), fmod_system(nullptr), bgm_channel_group(nullptr), vr_plugin_handle(0), vr_source_plugin_handle(0), vr_listener_dsp(nullptr), vr_player_source_dsp(nullptr), vr_initialized(false), vr_player_sounds_group(nullptr) {
-    // Initialize BGM slots (32 slots should be enough)
-    bgm_slots.resize(32);
-
+AudioBackendContext::AudioBackendContext() : last_error(""), backend_initialized(false), fmod_system(nullptr), core_config(), bgm_channel_group(nullptr), vr_plugin_handle(0), vr_source_plugin_handle(0), vr_listener_dsp(nullptr), vr_player_source_dsp(nullptr), vr_initialized(false), vr_player_sounds_group(nullptr), command_queue(4096) {
     // Initialize VR listener attributes to default values
     // pos=0,0,0 vel=0,0,0 forward=0,0,1 up=0,1,0
     vr_listener_attributes.pos = { 0.0f, 0.0f, 0.0f };
@@ -24,6 +22,8 @@ AudioBackendContext::AudioBackendContext() : last_error(""), backend_initialized
     vr_player_position = { 0.0f, 0.0f, 0.0f };
     vr_player_forward = { 0.0f, 0.0f, 1.0f };
     vr_player_up = { 0.0f, 1.0f, 0.0f };
+
+    InitializeSRWLock(&bgm_playlist_lock);
 }
 
 AudioBackendContext::~AudioBackendContext() {
@@ -53,6 +53,14 @@ void AudioBackendContext::SetFmodSystem(FMOD::System* system) {
     fmod_system = system;
 }
 
+const AudioCoreConfig& AudioBackendContext::GetCoreConfig() const {
+    return core_config;
+}
+
+void AudioBackendContext::SetCoreConfig(const AudioCoreConfig& config) {
+    core_config = config;
+}
+
 FMOD::ChannelGroup* AudioBackendContext::GetBgmChannelGroup() const {
     return bgm_channel_group;
 }
@@ -65,10 +73,46 @@ std::vector<BgmSlot>& AudioBackendContext::GetBgmSlots() {
     return bgm_slots;
 }
 
-std::unordered_map<std::string, FMOD::Sound*>& AudioBackendContext::GetSamplesMap() {
+std::vector<int>& AudioBackendContext::GetBgmFreeSlots() {
+    return bgm_free_slots;
+}
+
+BgmStreamSettings& AudioBackendContext::GetBgmStreamSettings() {
+    return bgm_stream_settings;
+}
+
+std::vector<MusicGroup>& AudioBackendContext::GetMusicGroups() {
+    return music_groups;
+}
+
+std::vector<BgmPlaylist>& AudioBackendContext::GetBgmPlaylists() {
+    return bgm_playlists;
+}
+
+SRWLOCK* AudioBackendContext::GetBgmPlaylistLock() {
+    return &bgm_playlist_lock;
+}
+
+std::vector<SampleSlot>& AudioBackendContext::GetSampleSlots() {
+    return sample_slots;
+}
+
+PoolStringMap<int>& AudioBackendContext::GetSamplesMap() {
     return samples_map;
 }
 
+SampleCache& AudioBackendContext::GetSampleCache() {
+    return sample_cache;
+}
+
+std::vector<SampleGroup>& AudioBackendContext::GetSampleGroups() {
+    return sample_groups;
+}
+
+std::vector<MountedBank>& AudioBackendContext::GetBanks() {
+    return banks;
+}
+
 unsigned int AudioBackendContext::GetVrPluginHandle() const {
     return vr_plugin_handle;
 }
@@ -153,6 +197,19 @@ std::vector<StoredRoom>& AudioBackendContext::GetVrRooms() {
     return vr_rooms;
 }
 
-std::unordered_map<std::string, VRObject>& AudioBackendContext::GetVrObjects() {
+PoolStringMap<VRObject>& AudioBackendContext::GetVrObjects() {
     return vr_objects;
 }
+
+CommandQueue& AudioBackendContext::GetCommandQueue() {
+    return command_queue;
+}
+
+bool AudioBackendContext::PushCommand(const AudioCommand& command) {
+    if (!command_queue.push(command)) {
+        last_error = "Command queue is full";
+        return false;
+    }
+    wakeWorkingThread();
+    return true;
+}
@@ -1,22 +1,179 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <Windows.h>
 #include "fmod/fmod.hpp"
 #include "vrstructs.h"
 #include "vrobj.h"
+#include "command_queue.h"
+#include "core.h"
+#include "memory_pool.h"
+#include "mapped_file.h"
+#include "bank_format.h"
+#include "sample.h"
+#include "sample_group.h"
+#include "music_group.h"
 
 // Structure to hold BGM slot data
 struct BgmSlot {
     FMOD::Sound* sound;
     FMOD::Channel* channel;
     void* buffer;  // Copied memory buffer
+    MappedFile mapped;  // Memory-mapped file the stream reads from (bgmLoadFile)
     int loop_point_ms;
+    bool is_stream;  // Streamed instead of decoded up front (bgmLoadPoint / bgmLoadFile / bgmOpenStream)
+    bool is_opening;  // Opened with FMOD_NONBLOCKING (bgmOpenStream) and not seen ready yet
+    bool was_starving;  // Starving at the last bgmGetStreamState
+    int starve_count;  // Starves seen by bgmGetStreamState
+    // Beat grid for quantized transitions (bgmSetTempo), bpm 0 = not set
+    float bpm;
+    int beats_per_bar;
+    int first_beat_ms;  // Position of the first downbeat in the file
+    bool is_paused;  // Paused by bgmPause, set when queued so it holds before the working thread applies it
+    unsigned int generation;  // Must match the generation in the handle
     bool is_used;
 
-    BgmSlot() : sound(nullptr), channel(nullptr), buffer(nullptr), loop_point_ms(-1), is_used(false) {}
+    BgmSlot() : sound(nullptr), channel(nullptr), buffer(nullptr), loop_point_ms(-1), is_stream(false), is_opening(false), was_starving(false), starve_count(0), bpm(0.0f), beats_per_bar(0), first_beat_ms(0), is_paused(false), generation(0), is_used(false) {}
+};
+
+// Buffers of the BGM streams opened from now on (bgmSetStreamBufferSize)
+struct BgmStreamSettings {
+    int file_buffer_bytes;  // System::setStreamBufferSize, 0 = FMOD default
+    int decode_buffer_ms;  // FMOD_CREATESOUNDEXINFO::decodebuffersize, 0 = FMOD default
+
+    BgmStreamSettings() : file_buffer_bytes(0), decode_buffer_ms(0) {}
+};
+
+// BGM slots played as the layers of one piece, indexed by the music group handle
+struct MusicGroup {
+    int layers[MUSIC_GROUP_MAX_LAYERS];  // BGM handles
+    int count;
+    // Layer volume ramps (fade points), in BGM channel group DSP clocks
+    float volumes[MUSIC_GROUP_MAX_LAYERS];  // Target, held after ramp_end
+    float ramp_from[MUSIC_GROUP_MAX_LAYERS];
+    unsigned long long ramp_start[MUSIC_GROUP_MAX_LAYERS];
+    unsigned long long ramp_end[MUSIC_GROUP_MAX_LAYERS];
+    unsigned int generation;  // Must match the generation in the handle
+    bool is_used;
+
+    MusicGroup() : layers(), count(0), volumes(), ramp_from(), ramp_start(), ramp_end(), generation(0), is_used(false) {}
+};
+
+// One slot of a BGM playlist
+struct PlaylistSegment {
+    int slot;  // BGM handle
+    FMOD::Sound* sound;
+    int end_ms;  // Hand-over marker, -1 for the end of the slot
+};
+
+// Structure to hold a BGM playlist, indexed by the playlist handle
+struct BgmPlaylist {
+    std::vector<PlaylistSegment> segments;
+    int current;  // Segment playing, -1 when stopped
+    FMOD::Channel* channel;  // Channel of the current segment
+    unsigned long long start_clock;  // BGM group DSP clock the current segment started at
+    unsigned long long end_clock;  // Clock it hands over at, 0 until it has a next segment
+    FMOD::Channel* next_channel;  // Next segment, waiting for next_start_clock
+    unsigned long long next_start_clock;
+    unsigned int generation;  // Must match the generation in the handle
+    bool is_used;
+
+    BgmPlaylist() : current(-1), channel(nullptr), start_clock(0), end_clock(0), next_channel(nullptr), next_start_clock(0), generation(0), is_used(false) {}
+};
+
+// A channel playing a sample, tracked while the sample has an instance limit
+struct SampleVoice {
+    FMOD::Channel* channel;
+    float distance;  // Distance from the listener when it started, 0 for 2D oneshots
+};
+
+// Structure to hold a sample, indexed by the sample handle
+struct SampleSlot {
+    FMOD::Sound* sound;  // Null while the sample is evicted (or registered but not played yet)
+    unsigned int generation;  // Must match the generation in the handle
+    bool is_used;
+    bool is_loading;  // Opened with FMOD_NONBLOCKING and not seen ready yet
+    PoolString key;
+    // Source to decode from again after eviction, both empty for audio_sampleLoad (never evicted)
+    const void* source_data;  // Caller-owned memory (audio_sampleRegister)
+    int source_size;
+    PoolString source_path;  // File path (audio_sampleRegisterFile)
+    bool is_compressed;  // Kept compressed in memory (FMOD_CREATECOMPRESSEDSAMPLE)
+    size_t pcm_bytes;  // Decoded PCM size while loaded
+    size_t memory_bytes;  // Resident size while loaded, the compressed data for compressed samples
+    // Content deduplication (sampleLoad): slots loaded from the same bytes share one sound
+    // The owner is the slot the sound's user data points to, it holds the memory and the voice settings
+    uint64_t content_key;  // Hash of the loaded bytes and the load mode, 0 if not shared
+    int content_size;
+    int shared_owner;  // Owner slot, itself for the owner, -1 if not shared
+    int share_count;  // Slots using the sound, owner only
+    unsigned int length_ms;
+    unsigned long long busy_until_ms;  // May still be playing until this tick count
+    int pin_count;  // VR objects using it as their looped sound, never evicted while pinned
+    int bank;  // Mounted bank the source points into (FMOD_OPENMEMORY_POINT), -1 for none
+    MappedFile pcm_cache_file;  // Cached PCM the sound plays in place, unmapped after the sound is released
+    SampleLoudness loudness;  // Load-time analysis, loudness.analyzed is 0 without one
+    int lru_prev;  // LRU list of loaded evictable samples, -1 terminated
+    int lru_next;
+    int max_instances;  // 0 = unlimited
+    int steal_policy;  // SAMPLE_STEAL_*
+    int category;  // Selects the channel priority
+    std::vector<SampleVoice> voices;  // Oldest first, only while max_instances > 0
+
+    SampleSlot() : sound(nullptr), generation(0), is_used(false), is_loading(false), source_data(nullptr), source_size(0), is_compressed(false), pcm_bytes(0), memory_bytes(0), content_key(0), content_size(0), shared_owner(-1), share_count(0), length_ms(0), busy_until_ms(0), pin_count(0), bank(-1), loudness(), lru_prev(-1), lru_next(-1), max_instances(0), steal_policy(0), category(0) {}
+
+    bool isEvictable() const { return source_data != nullptr || !source_path.empty(); }
+};
+
+// Decoded sample memory accounting, the LRU list ends and category priorities
+struct SampleCache {
+    int lru_head;  // Most recently played
+    int lru_tail;  // Evicted first
+    size_t loaded_bytes;  // Resident memory of every loaded sample
+    size_t budget_bytes;  // 0 = unlimited
+    std::vector<int> free_slots;  // Unloaded slots waiting for reuse
+    std::unordered_map<uint64_t, int> shared_sounds;  // Content key to the owner slot
+    int category_priorities[SAMPLE_CATEGORY_COUNT];  // FMOD channel priority per category
+    std::string pcm_cache_dir;  // Decoded PCM cache (sampleSetPcmCache), empty = off
+    int pcm_cache_hits;
+    int pcm_cache_misses;
+
+    SampleCache() : lru_head(-1), lru_tail(-1), loaded_bytes(0), budget_bytes(0), pcm_cache_hits(0), pcm_cache_misses(0) {
+        for (int& priority : category_priorities) {
+            priority = SAMPLE_DEFAULT_PRIORITY;
+        }
+    }
+};
+
+// Structure to hold a sound group, indexed by the group handle
+struct SampleGroup {
+    int members[SAMPLE_GROUP_MAX_MEMBERS];  // Sample handles
+    int count;
+    float pitch_min;
+    float pitch_max;
+    float volume_min;
+    float volume_max;
+    int policy;  // SAMPLE_GROUP_*
+    int last;  // Member picked by the previous play, -1 before the first
+    uint32_t rng;  // xorshift32 state
+    unsigned int generation;  // Must match the generation in the handle
+    bool is_used;
+    PoolString key;
+
+    SampleGroup() : members(), count(0), pitch_min(0.0f), pitch_max(0.0f), volume_min(0.0f), volume_max(0.0f), policy(0), last(-1), rng(0), generation(0), is_used(false) {}
+};
+
+// Memory-mapped sample bank, samples are registered from it on first lookup by key
+struct MountedBank {
+    MappedFile mapped;
+    BankImage image;
+    bool is_used;
+
+    MountedBank() : is_used(false) {}
 };
 
 class AudioBackendContext {
@@ -24,9 +181,21 @@ private:
     std::string last_error;
     bool backend_initialized;
     FMOD::System* fmod_system;
+    AudioCoreConfig core_config;  // Configuration the system was initialized with
     FMOD::ChannelGroup* bgm_channel_group;
-    std::vector<BgmSlot> bgm_slots;
-    std::unordered_map<std::string, FMOD::Sound*> samples_map;
+    std::vector<BgmSlot> bgm_slots;  // Indexed by the BGM handle, grows on demand
+    std::vector<int> bgm_free_slots;  // Freed slots waiting for reuse
+    BgmStreamSettings bgm_stream_settings;
+    std::vector<MusicGroup> music_groups;
+    // Playlists are edited on the game thread and advanced by updateBgmPlaylists
+    // on the thread that drives the mixer (the working thread, or coreRenderFrames)
+    std::vector<BgmPlaylist> bgm_playlists;
+    SRWLOCK bgm_playlist_lock;
+    std::vector<SampleSlot> sample_slots;
+    PoolStringMap<int> samples_map;  // Key to sample handle
+    SampleCache sample_cache;
+    std::vector<SampleGroup> sample_groups;
+    std::vector<MountedBank> banks;  // Indexed by the bank id
 
     // VR audio related
     unsigned int vr_plugin_handle;
@@ -40,7 +209,10 @@ private:
     FMOD_VECTOR vr_player_forward;
     FMOD_VECTOR vr_player_up;
     std::vector<StoredRoom> vr_rooms;
-    std::unordered_map<std::string, VRObject> vr_objects;
+    PoolStringMap<VRObject> vr_objects;
+
+    // Commands waiting to be applied by the working thread
+    CommandQueue command_queue;
 
 public:
     AudioBackendContext();
@@ -55,12 +227,32 @@ public:
     FMOD::System* GetFmodSystem() const;
     void SetFmodSystem(FMOD::System* system);
 
+    const AudioCoreConfig& GetCoreConfig() const;
+    void SetCoreConfig(const AudioCoreConfig& config);
+
     FMOD::ChannelGroup* GetBgmChannelGroup() const;
     void SetBgmChannelGroup(FMOD::ChannelGroup* group);
 
     std::vector<BgmSlot>& GetBgmSlots();
 
-    std::unordered_map<std::string, FMOD::Sound*>& GetSamplesMap();
+    std::vector<int>& GetBgmFreeSlots();
+
+    BgmStreamSettings& GetBgmStreamSettings();
+
+    std::vector<MusicGroup>& GetMusicGroups();
+
+    std::vector<BgmPlaylist>& GetBgmPlaylists();
+    SRWLOCK* GetBgmPlaylistLock();
+
+    std::vector<SampleSlot>& GetSampleSlots();
+
+    PoolStringMap<int>& GetSamplesMap();
+
+    SampleCache& GetSampleCache();
+
+    std::vector<SampleGroup>& GetSampleGroups();
+
+    std::vector<MountedBank>& GetBanks();
 
     // VR audio related getters/setters
     unsigned int GetVrPluginHandle() const;
@@ -95,7 +287,13 @@ public:
 
     std::vector<StoredRoom>& GetVrRooms();
 
-    std::unordered_map<std::string, VRObject>& GetVrObjects();
+    PoolStringMap<VRObject>& GetVrObjects();
+
+    CommandQueue& GetCommandQueue();
+
+    // Push a command for the working thread
+    // Returns false and sets the last error if the queue is full
+    bool PushCommand(const AudioCommand& command);
 };
 
 // Global function to check if backend is initialized
@@ -1,23 +1,172 @@
 #include "context.h"
+#include "core.h"
 #include "working_thread.h"
+#include "render.h"
+#include "stats.h"
+#include "memory_pool.h"
+#include "vrsourcepool.h"
+#include "bank.h"
+#include "bgm.h"
+#include "bgm_playlist.h"
 #include "fmod/fmod.hpp"
 #include "fmod/fmod_errors.h"
 
 // External declaration of global context
 extern AudioBackendContext* g_context;
 
+// Default number of virtual channels
+// 512 channels should be sufficient for most games
+static const int DEFAULT_MAX_CHANNELS = 512;
+
+// Apply the pre-init parts of the configuration to a created (not yet initialized) system
+// Returns false and sets the last error on failure
+static bool applyCoreConfig(FMOD::System* system, const AudioCoreConfig& config) {
+    FMOD_RESULT result;
+
+    if (config.output_type != 0) {
+        if (config.output_type < 0 || config.output_type >= FMOD_OUTPUTTYPE_MAX) {
+            g_context->SetLastError("Invalid output type: " + std::to_string(config.output_type));
+            return false;
+        }
+        result = system->setOutput(static_cast<FMOD_OUTPUTTYPE>(config.output_type));
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to set output type: ") + FMOD_ErrorString(result));
+            return false;
+        }
+    }
+
+    if (config.real_voices != 0) {
+        result = system->setSoftwareChannels(config.real_voices);
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to set software channels: ") + FMOD_ErrorString(result));
+            return false;
+        }
+    }
+
+    if (config.sample_rate != 0 || config.speaker_mode != 0) {
+        if (config.speaker_mode < 0 || config.speaker_mode >= FMOD_SPEAKERMODE_MAX) {
+            g_context->SetLastError("Invalid speaker mode: " + std::to_string(config.speaker_mode));
+            return false;
+        }
+        // Keep the current value for whichever field was left at 0
+        int rate = 0;
+        FMOD_SPEAKERMODE speaker_mode = FMOD_SPEAKERMODE_DEFAULT;
+        int raw_speakers = 0;
+        system->getSoftwareFormat(&rate, &speaker_mode, &raw_speakers);
+        if (config.sample_rate != 0) {
+            rate = config.sample_rate;
+        }
+        if (config.speaker_mode != 0) {
+            speaker_mode = static_cast<FMOD_SPEAKERMODE>(config.speaker_mode);
+        }
+        result = system->setSoftwareFormat(rate, speaker_mode, raw_speakers);
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to set software format: ") + FMOD_ErrorString(result));
+            return false;
+        }
+    }
+
+    if (config.dsp_buffer_length != 0 || config.dsp_buffer_count != 0) {
+        unsigned int buffer_length = 0;
+        int buffer_count = 0;
+        system->getDSPBufferSize(&buffer_length, &buffer_count);
+        if (config.dsp_buffer_length != 0) {
+            buffer_length = static_cast<unsigned int>(config.dsp_buffer_length);
+        }
+        if (config.dsp_buffer_count != 0) {
+            buffer_count = config.dsp_buffer_count;
+        }
+        result = system->setDSPBufferSize(buffer_length, buffer_count);
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to set DSP buffer size: ") + FMOD_ErrorString(result));
+            return false;
+        }
+    }
+
+    if (config.max_mpeg_codecs != 0 || config.max_adpcm_codecs != 0 || config.max_vorbis_codecs != 0 ||
+        config.max_fadpcm_codecs != 0 || config.max_opus_codecs != 0) {
+        FMOD_ADVANCEDSETTINGS settings = {};
+        settings.cbSize = sizeof(FMOD_ADVANCEDSETTINGS);
+        system->getAdvancedSettings(&settings);
+        if (config.max_mpeg_codecs != 0) settings.maxMPEGCodecs = config.max_mpeg_codecs;
+        if (config.max_adpcm_codecs != 0) settings.maxADPCMCodecs = config.max_adpcm_codecs;
+        if (config.max_vorbis_codecs != 0) settings.maxVorbisCodecs = config.max_vorbis_codecs;
+        if (config.max_fadpcm_codecs != 0) settings.maxFADPCMCodecs = config.max_fadpcm_codecs;
+        if (config.max_opus_codecs != 0) settings.maxOpusCodecs = config.max_opus_codecs;
+        result = system->setAdvancedSettings(&settings);
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to set advanced settings: ") + FMOD_ErrorString(result));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Undo a failed initialization after the FMOD system has been released, so a retry starts from scratch
+// The context's containers come from the backend arena, so the context is recreated on the heap to keep the error
+static int failInitialize() {
+    std::string error = g_context->getLastError();
+    delete g_context;
+    g_context = nullptr;
+    fmodArenaFree();
+    memoryPoolShutdown();
+
+    g_context = new AudioBackendContext();
+    g_context->SetLastError(error);
+    return -1;
+}
+
 extern "C" {
 
 // Initialize FMOD and the audio backend
 int coreInitialize() {
+    return coreInitializeEx(nullptr);
+}
+
+// Initialize FMOD and the audio backend with a mixer configuration
+// config can be null to use the defaults
+int coreInitializeEx(const AudioCoreConfig* config) {
     // If already initialized, return success immediately
     if (isBackendInitialized()) {
         return 0;
     }
 
-    // Create context if not exists
-    if (g_context == nullptr) {
+    AudioCoreConfig core_config = {};
+    if (config != nullptr) {
+        core_config = *config;
+    }
+
+    // A context left over from a failed initialization only holds its error,
+    // recreate it so the new context's containers come from the new arena
+    delete g_context;
+    g_context = nullptr;
+
+    if (core_config.backend_arena_bytes < 0) {
         g_context = new AudioBackendContext();
+        g_context->SetLastError("Invalid backend arena size: " + std::to_string(core_config.backend_arena_bytes));
+        return -1;
+    }
+
+    // The backend arena has to exist before the context, so the context's containers come from it
+    bool arena_ok = memoryPoolInitialize(static_cast<size_t>(core_config.backend_arena_bytes));
+    g_context = new AudioBackendContext();
+    if (!arena_ok) {
+        g_context->SetLastError("Failed to allocate backend memory arena: " + std::to_string(core_config.backend_arena_bytes) + " bytes");
+        return -1;
+    }
+
+    if (core_config.max_channels == 0) {
+        core_config.max_channels = DEFAULT_MAX_CHANNELS;
+    }
+    if (core_config.max_channels < 0) {
+        g_context->SetLastError("Invalid max channels: " + std::to_string(core_config.max_channels));
+        return failInitialize();
+    }
+
+    // FMOD's arena must be in place before the system is created
+    if (!fmodArenaInitialize(core_config.fmod_arena_bytes)) {
+        return failInitialize();
     }
 
     // Create FMOD system instance
@@ -25,20 +174,38 @@ int coreInitialize() {
     FMOD_RESULT result = FMOD::System_Create(&system);
     if (result != FMOD_OK) {
         g_context->SetLastError(std::string("Failed to create FMOD system: ") + FMOD_ErrorString(result));
-        return -1;
+        return failInitialize();
+    }
+
+    // Output, mixer format and codec pools must be set before init
+    if (!applyCoreConfig(system, core_config)) {
+        system->release();
+        return failInitialize();
     }
 
-    // Initialize FMOD system with default parameters
-    // maxchannels: 512 channels should be sufficient for most games
+    // Initialize FMOD system
     // flags: FMOD_INIT_NORMAL for standard initialization
-    result = system->init(512, FMOD_INIT_NORMAL, nullptr);
+    // In non-realtime mode streams are also decoded from update() so renders are deterministic
+    bool non_realtime = isNonRealtimeOutput(core_config.output_type);
+    FMOD_INITFLAGS init_flags = FMOD_INIT_NORMAL;
+    void* extra_driver_data = nullptr;
+    if (non_realtime) {
+        init_flags |= FMOD_INIT_STREAM_FROM_UPDATE;
+        if (core_config.output_type == FMOD_OUTPUTTYPE_WAVWRITER_NRT) {
+            extra_driver_data = const_cast<char*>(core_config.wav_output_path);
+        }
+    }
+    result = system->init(core_config.max_channels, init_flags, extra_driver_data);
     if (result != FMOD_OK) {
         g_context->SetLastError(std::string("Failed to initialize FMOD system: ") + FMOD_ErrorString(result));
         system->release();
-        return -1;
+        return failInitialize();
     }
 
     g_context->SetFmodSystem(system);
+    // The path is only needed by init, don't keep the caller's pointer around
+    core_config.wav_output_path = nullptr;
+    g_context->SetCoreConfig(core_config);
 
     // Create BGM channel group
     FMOD::ChannelGroup* bgmGroup = nullptr;
@@ -47,11 +214,26 @@ int coreInitialize() {
         g_context->SetLastError(std::string("Failed to create BGM channel group: ") + FMOD_ErrorString(result));
         system->release();
         g_context->SetFmodSystem(nullptr);
-        return -1;
+        return failInitialize();
     }
     g_context->SetBgmChannelGroup(bgmGroup);
 
     g_context->setBackendInitialized(true);
+    resetStatsSnapshot();
+
+    // In non-realtime mode the mixer only advances through coreRenderFrames,
+    // so there is no working thread; capture the master output instead
+    if (non_realtime) {
+        if (!startRenderCapture(system)) {
+            bgmGroup->release();
+            system->release();
+            g_context->SetBgmChannelGroup(nullptr);
+            g_context->SetFmodSystem(nullptr);
+            g_context->setBackendInitialized(false);
+            return failInitialize();
+        }
+        return 0;
+    }
 
     // Start working thread for automatic FMOD updates
     if (!startWorkingThread()) {
@@ -61,7 +243,7 @@ int coreInitialize() {
         g_context->SetBgmChannelGroup(nullptr);
         g_context->SetFmodSystem(nullptr);
         g_context->setBackendInitialized(false);
-        return -1;
+        return failInitialize();
     }
 
     return 0;
@@ -73,19 +255,59 @@ void coreFree() {
         return;
     }
 
-    // Stop working thread before closing FMOD
+    // Stop working thread (or the render capture) before closing FMOD
     stopWorkingThread();
+    stopRenderCapture();
 
     // Get FMOD system and close it
     FMOD::System* system = g_context->GetFmodSystem();
     if (system != nullptr) {
+        // Apply commands the working thread did not get to
+        drainCommandQueue(g_context->GetCommandQueue(), system);
+        bgmPlaylistShutdown();
+        bgmShutdown();
+        vrSourcePoolShutdown();
         system->close();
         system->release();
     }
+    // Bank and PCM cache samples are played in place, so unmap only after every sound is gone
+    bankShutdown();
+    unmapSamplePcmCache();
 
     // Delete the context
     delete g_context;
     g_context = nullptr;
+
+    // Arenas go last, after everything allocated from them
+    fmodArenaFree();
+    memoryPoolShutdown();
+}
+
+// Get the master channel group's DSP clock (in samples at the mixer rate)
+int coreGetDSPClock(unsigned long long* clock, int* sample_rate) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    FMOD::System* system = g_context->GetFmodSystem();
+    FMOD::ChannelGroup* masterGroup = nullptr;
+    FMOD_RESULT result = system->getMasterChannelGroup(&masterGroup);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to get master channel group: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+
+    if (clock != nullptr) {
+        result = masterGroup->getDSPClock(clock, nullptr);
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to get DSP clock: ") + FMOD_ErrorString(result));
+            return -1;
+        }
+    }
+    if (sample_rate != nullptr) {
+        system->getSoftwareFormat(sample_rate, nullptr, nullptr);
+    }
+    return 0;
 }
 
 } // extern "C"
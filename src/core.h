@@ -5,9 +5,36 @@
 extern "C" {
 #endif
 
+// Mixer configuration for coreInitializeEx
+// A value of 0 keeps the FMOD default for that field
+typedef struct {
+    int max_channels;       // Virtual channels (System::init maxchannels), backend default 512
+    int real_voices;        // Real voices actually mixed (setSoftwareChannels)
+    int sample_rate;        // Mixer sample rate in Hz (setSoftwareFormat)
+    int speaker_mode;       // FMOD_SPEAKERMODE value (setSoftwareFormat)
+    int dsp_buffer_length;  // Mixer block length in samples (setDSPBufferSize)
+    int dsp_buffer_count;   // Number of mixer blocks (setDSPBufferSize)
+    int output_type;        // FMOD_OUTPUTTYPE value (setOutput)
+                            // NOSOUND_NRT / WAVWRITER_NRT select the headless render mode
+    const char* wav_output_path;  // Output file for WAVWRITER_NRT, null for FMOD's default name
+    // Codec pool sizes (setAdvancedSettings), pre-allocated at init
+    int max_mpeg_codecs;
+    int max_adpcm_codecs;
+    int max_vorbis_codecs;
+    int max_fadpcm_codecs;
+    int max_opus_codecs;
+    // Preallocated arenas, 0 to use the system heap
+    int fmod_arena_bytes;     // Handed to FMOD (FMOD_Memory_Initialize)
+    int backend_arena_bytes;  // Backend's own allocations (keys, room strings, BGM buffers)
+} AudioCoreConfig;
+
 int coreInitialize();
+int coreInitializeEx(const AudioCoreConfig* config);
 void coreFree();
 
+// Current master DSP clock and mixer rate, for scheduling on the mixer's sample clock
+int coreGetDSPClock(unsigned long long* clock, int* sample_rate);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,49 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 64-bit FNV-1a, used for the backend's string keys
+inline uint64_t hashFnv1a(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Fast 64-bit hash for sample data blobs, 8 bytes per step (not cryptographic)
+inline uint64_t hashBytes64(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const uint64_t k = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = static_cast<uint64_t>(length) * k;
+    size_t i = 0;
+    for (;; i += 8) {
+        uint64_t word = 0;
+        size_t n = length - i < 8 ? length - i : 8;
+        if (n == 0) {
+            break;
+        }
+        memcpy(&word, bytes + i, n);
+        word *= 0xbf58476d1ce4e5b9ULL;
+        word ^= word >> 31;
+        hash = (hash ^ word) * k;
+        hash ^= hash >> 29;
+        if (n < 8) {
+            break;
+        }
+    }
+    // splitmix64 finalizer
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+#endif // HASH_H
@@ -3,13 +3,21 @@
 #include "version.h"
 #include "context.h"
 #include "bgm.h"
+#include "bgm_playlist.h"
+#include "music_group.h"
 #include "core.h"
 #include "sample.h"
+#include "sample_group.h"
+#include "bank.h"
 #include "vr.h"
 #include "vrobj.h"
 #include "vrplayer.h"
 #include "vrroom.h"
+#include "vrsourcepool.h"
 #include "plugin_inspector.h"
+#include "render.h"
+#include "stats.h"
+#include "memory_pool.h"
 
 // External declaration of global context
 extern AudioBackendContext* g_context;
@@ -21,10 +29,36 @@ extern "C" {
         return coreInitialize();
     }
 
+    __declspec(dllexport) int audio_coreInitializeEx(const AudioCoreConfig* config) {
+        return coreInitializeEx(config);
+    }
+
     __declspec(dllexport) void audio_coreFree() {
         coreFree();
     }
 
+    __declspec(dllexport) int audio_coreGetDSPClock(unsigned long long* clock, int* sample_rate) {
+        return coreGetDSPClock(clock, sample_rate);
+    }
+
+    // Headless render API functions
+    __declspec(dllexport) int audio_coreRenderFrames(int frames, float* buffer, int buffer_length) {
+        return coreRenderFrames(frames, buffer, buffer_length);
+    }
+
+    __declspec(dllexport) int audio_coreGetRenderFormat(int* sample_rate, int* channels) {
+        return coreGetRenderFormat(sample_rate, channels);
+    }
+
+    // Statistics API functions
+    __declspec(dllexport) int audio_coreGetStats(AudioStats* stats) {
+        return coreGetStats(stats);
+    }
+
+    __declspec(dllexport) int audio_coreGetMemoryStats(AudioMemoryStats* stats) {
+        return coreGetMemoryStats(stats);
+    }
+
     // Version API functions
     __declspec(dllexport) int audio_versionGetMajor() {
         return getMajorVersion();
@@ -65,6 +99,26 @@ extern "C" {
         return bgmLoad(address, size);
     }
 
+    __declspec(dllexport) int audio_bgmLoadPoint(const void* address, int size) {
+        return bgmLoadPoint(address, size);
+    }
+
+    __declspec(dllexport) int audio_bgmLoadFile(const char* path) {
+        return bgmLoadFile(path);
+    }
+
+    __declspec(dllexport) int audio_bgmOpenStream(const char* path) {
+        return bgmOpenStream(path);
+    }
+
+    __declspec(dllexport) int audio_bgmSetStreamBufferSize(int file_buffer_bytes, int decode_buffer_ms) {
+        return bgmSetStreamBufferSize(file_buffer_bytes, decode_buffer_ms);
+    }
+
+    __declspec(dllexport) int audio_bgmGetStreamState(int slot, BgmStreamState* state) {
+        return bgmGetStreamState(slot, state);
+    }
+
     __declspec(dllexport) int audio_bgmPause(int slot) {
         return bgmPause(slot);
     }
@@ -93,6 +147,26 @@ extern "C" {
         return bgmSetLoopPoint(slot, ms);
     }
 
+    __declspec(dllexport) int audio_bgmSetTempo(int slot, float bpm, int beats_per_bar, int first_beat_ms) {
+        return bgmSetTempo(slot, bpm, beats_per_bar, first_beat_ms);
+    }
+
+    __declspec(dllexport) int audio_bgmAddMarker(int slot, int ms) {
+        return bgmAddMarker(slot, ms);
+    }
+
+    __declspec(dllexport) int audio_bgmClearMarkers(int slot) {
+        return bgmClearMarkers(slot);
+    }
+
+    __declspec(dllexport) int audio_bgmGetQuantizedClock(int slot, int quantize, unsigned long long* clock) {
+        return bgmGetQuantizedClock(slot, quantize, clock);
+    }
+
+    __declspec(dllexport) int audio_bgmCrossfadeQuantized(int slot1, int slot2, int ms, int quantize) {
+        return bgmCrossfadeQuantized(slot1, slot2, ms, quantize);
+    }
+
     __declspec(dllexport) int audio_bgmPlay(int slot) {
         return bgmPlay(slot);
     }
@@ -101,20 +175,180 @@ extern "C" {
         return bgmFree(slot);
     }
 
+    __declspec(dllexport) int audio_bgmPlaylistCreate() {
+        return bgmPlaylistCreate();
+    }
+
+    __declspec(dllexport) int audio_bgmPlaylistFree(int playlist) {
+        return bgmPlaylistFree(playlist);
+    }
+
+    __declspec(dllexport) int audio_bgmPlaylistAppend(int playlist, int slot, int end_ms) {
+        return bgmPlaylistAppend(playlist, slot, end_ms);
+    }
+
+    __declspec(dllexport) int audio_bgmPlaylistPlay(int playlist) {
+        return bgmPlaylistPlay(playlist);
+    }
+
+    __declspec(dllexport) int audio_bgmPlaylistStop(int playlist) {
+        return bgmPlaylistStop(playlist);
+    }
+
+    __declspec(dllexport) int audio_bgmPlaylistGetSegment(int playlist, int* segment) {
+        return bgmPlaylistGetSegment(playlist, segment);
+    }
+
+    __declspec(dllexport) int audio_musicGroupCreate(const int* slots, int count) {
+        return musicGroupCreate(slots, count);
+    }
+
+    __declspec(dllexport) int audio_musicGroupFree(int group) {
+        return musicGroupFree(group);
+    }
+
+    __declspec(dllexport) int audio_musicGroupPlay(int group) {
+        return musicGroupPlay(group);
+    }
+
+    __declspec(dllexport) int audio_musicGroupStop(int group) {
+        return musicGroupStop(group);
+    }
+
+    __declspec(dllexport) int audio_musicGroupSetLayerVolume(int group, int layer, float volume, int ms) {
+        return musicGroupSetLayerVolume(group, layer, volume, ms);
+    }
+
+    __declspec(dllexport) int audio_musicGroupSetLoopPoint(int group, int ms) {
+        return musicGroupSetLoopPoint(group, ms);
+    }
+
     // Sample API functions
     __declspec(dllexport) int audio_sampleLoad(const void* address, int size, const char* key) {
         return sampleLoad(address, size, key);
     }
 
+    __declspec(dllexport) int audio_sampleLoadEx(const void* address, int size, const char* key, const SampleLoadOptions* options) {
+        return sampleLoadEx(address, size, key, options);
+    }
+
+    __declspec(dllexport) int audio_sampleGetMemoryReport(SampleMemoryReport* report) {
+        return sampleGetMemoryReport(report);
+    }
+
+    __declspec(dllexport) int audio_sampleGetLoudness(const char* key, SampleLoudness* loudness) {
+        return sampleGetLoudness(key, loudness);
+    }
+
+    __declspec(dllexport) int audio_sampleSetPcmCache(const char* directory) {
+        return sampleSetPcmCache(directory);
+    }
+
+    __declspec(dllexport) int audio_sampleGetPcmCacheStats(int* hits, int* misses) {
+        return sampleGetPcmCacheStats(hits, misses);
+    }
+
     __declspec(dllexport) int audio_sampleOneshot(const char* key, SoundAttributes* attributes) {
         return sampleOneshot(key, attributes);
     }
 
+    __declspec(dllexport) int audio_sampleGetHandle(const char* key) {
+        return sampleGetHandle(key);
+    }
+
+    __declspec(dllexport) int audio_sampleOneshotHandle(int handle, SoundAttributes* attributes) {
+        return sampleOneshotHandle(handle, attributes);
+    }
+
+    __declspec(dllexport) int audio_sampleGroupCreate(const char* key, const int* sample_handles, int count, const SampleGroupConfig* config) {
+        return sampleGroupCreate(key, sample_handles, count, config);
+    }
+
+    __declspec(dllexport) int audio_sampleOneshotBatch(const OneshotCmd* commands, int count) {
+        return sampleOneshotBatch(commands, count);
+    }
+
+    __declspec(dllexport) int audio_sampleOneshotScheduled(const OneshotCmd* commands, int count, unsigned long long start_clock, int time_unit) {
+        return sampleOneshotScheduled(commands, count, start_clock, time_unit);
+    }
+
+    __declspec(dllexport) int audio_sampleSetVoiceLimit(const char* key, int max_instances, int steal_policy) {
+        return sampleSetVoiceLimit(key, max_instances, steal_policy);
+    }
+
+    __declspec(dllexport) int audio_sampleSetCategory(const char* key, int category) {
+        return sampleSetCategory(key, category);
+    }
+
+    __declspec(dllexport) int audio_sampleSetCategoryPriority(int category, int priority) {
+        return sampleSetCategoryPriority(category, priority);
+    }
+
+    __declspec(dllexport) int audio_sampleLoadAsync(const void* address, int size, const char* key) {
+        return sampleLoadAsync(address, size, key);
+    }
+
+    __declspec(dllexport) int audio_sampleLoadBatch(const SampleLoadRequest* requests, int count, int* handles) {
+        return sampleLoadBatch(requests, count, handles);
+    }
+
+    __declspec(dllexport) int audio_sampleGetOpenState(const char* key) {
+        return sampleGetOpenState(key);
+    }
+
+    __declspec(dllexport) int audio_sampleGetOpenStateBatch(const int* handles, int count, int* states) {
+        return sampleGetOpenStateBatch(handles, count, states);
+    }
+
+    __declspec(dllexport) int audio_sampleRegister(const void* address, int size, const char* key) {
+        return sampleRegister(address, size, key);
+    }
+
+    __declspec(dllexport) int audio_sampleRegisterFile(const char* path, const char* key) {
+        return sampleRegisterFile(path, key);
+    }
+
+    __declspec(dllexport) int audio_bankMount(const char* path) {
+        return bankMount(path);
+    }
+
+    __declspec(dllexport) int audio_bankUnmount(int bank) {
+        return bankUnmount(bank);
+    }
+
+    __declspec(dllexport) int audio_bankGetSampleCount(int bank) {
+        return bankGetSampleCount(bank);
+    }
+
+    __declspec(dllexport) int audio_sampleUnload(const char* key) {
+        return sampleUnload(key);
+    }
+
+    __declspec(dllexport) int audio_sampleUnloadHandle(int handle) {
+        return sampleUnloadHandle(handle);
+    }
+
+    __declspec(dllexport) int audio_sampleSetMemoryBudget(int bytes) {
+        return sampleSetMemoryBudget(bytes);
+    }
+
+    __declspec(dllexport) int audio_sampleGetMemoryUsage(int* loaded_bytes, int* budget_bytes) {
+        return sampleGetMemoryUsage(loaded_bytes, budget_bytes);
+    }
+
     // VR Audio API functions
     __declspec(dllexport) int audio_vrInitialize(const char* plugin_path) {
         return vrInitialize(plugin_path);
     }
 
+    __declspec(dllexport) int audio_vrInitializeEx(const char* plugin_path, const VrInitConfig* config) {
+        return vrInitializeEx(plugin_path, config);
+    }
+
+    __declspec(dllexport) int audio_vrGetSourcePoolStats(int* in_use, int* total) {
+        return vrGetSourcePoolStats(in_use, total);
+    }
+
     __declspec(dllexport) int audio_vrOneshotRelative(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow) {
         return vrOneshotRelative(sample_key, position3d, sound_attributes, follow);
     }
@@ -127,6 +361,18 @@ extern "C" {
         return vrOneshotPlayer(sample_key, sound_attributes);
     }
 
+    __declspec(dllexport) int audio_vrOneshotRelativeHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow) {
+        return vrOneshotRelativeHandle(sample_handle, position3d, sound_attributes, follow);
+    }
+
+    __declspec(dllexport) int audio_vrOneshotAbsoluteHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes) {
+        return vrOneshotAbsoluteHandle(sample_handle, position3d, sound_attributes);
+    }
+
+    __declspec(dllexport) int audio_vrOneshotPlayerHandle(int sample_handle, SoundAttributes* sound_attributes) {
+        return vrOneshotPlayerHandle(sample_handle, sound_attributes);
+    }
+
     __declspec(dllexport) int audio_vrPlayerSetPosition(float width, float depth, float height) {
         return setPlayerPosition(width, depth, height);
     }
@@ -172,6 +418,10 @@ extern "C" {
         return vrObjectPlayOneshot(object_key, sample_key, attributes);
     }
 
+    __declspec(dllexport) int audio_vrObjectPlayOneshotHandle(const char* object_key, int sample_handle, SoundAttributes* attributes) {
+        return vrObjectPlayOneshotHandle(object_key, sample_handle, attributes);
+    }
+
     __declspec(dllexport) int audio_vrObjectChangePosition(const char* key, Position3D pos) {
         return vrObjectChangePosition(key, pos);
     }
@@ -0,0 +1,52 @@
+#include "mapped_file.h"
+#include <Windows.h>
+
+bool mapFile(const char* path, MappedFile* mapped, std::string* error) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        *error = std::string("Failed to open file: ") + path;
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+        *error = std::string("File is empty or its size cannot be read: ") + path;
+        CloseHandle(file);
+        return false;
+    }
+
+    // Mapping the whole file reserves address space only, pages are read on demand
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        *error = std::string("Failed to create file mapping: ") + path;
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        *error = std::string("Failed to map file: ") + path;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mapped->file = file;
+    mapped->mapping = mapping;
+    mapped->data = data;
+    mapped->size = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void unmapFile(MappedFile* mapped) {
+    if (mapped->data != nullptr) {
+        UnmapViewOfFile(mapped->data);
+    }
+    if (mapped->mapping != nullptr) {
+        CloseHandle(mapped->mapping);
+    }
+    if (mapped->file != nullptr) {
+        CloseHandle(mapped->file);
+    }
+    *mapped = MappedFile();
+}
@@ -0,0 +1,24 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file
+struct MappedFile {
+    void* file;     // File handle
+    void* mapping;  // File mapping handle
+    const void* data;
+    size_t size;
+
+    MappedFile() : file(nullptr), mapping(nullptr), data(nullptr), size(0) {}
+};
+
+// Map the file for reading
+// Returns false and fills error on failure
+bool mapFile(const char* path, MappedFile* mapped, std::string* error);
+
+// Unmap the file, does nothing if it is not mapped
+void unmapFile(MappedFile* mapped);
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,397 @@
+#include "memory_pool.h"
+#include "context.h"
+#include "fmod/fmod.h"
+#include "fmod/fmod_errors.h"
+#include <cstdint>
+#include <cstdlib>
+#include <Windows.h>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+// Every block starts with this header, so poolFree works without a size
+struct BlockHeader {
+    uint64_t size;  // Block size including the header
+    uint32_t tag;   // Size class index, or one of the BLOCK_* tags
+    uint32_t magic;
+};
+
+// Free large blocks are kept in an address ordered list so neighbours can be merged
+struct FreeBlock {
+    BlockHeader header;
+    FreeBlock* next;
+};
+
+// Free small blocks are kept in one list per size class
+struct FreeSmallBlock {
+    BlockHeader header;
+    FreeSmallBlock* next;
+};
+
+static const uint32_t BLOCK_LARGE = 0xFD;
+static const uint32_t BLOCK_CHUNK = 0xFE;
+static const uint32_t BLOCK_HEAP = 0xFF;
+static const uint32_t BLOCK_MAGIC = 0xA0D10B0C;
+
+static const size_t HEADER_SIZE = sizeof(BlockHeader);
+static const size_t BLOCK_ALIGN = 16;
+// Smallest remainder worth splitting off a large block
+static const size_t MIN_SPLIT_SIZE = 64;
+
+// Small allocations (keys, short strings, map nodes) use fixed size classes
+// carved out of chunks, so they never fragment the large free list
+static const size_t SMALL_CLASS_SIZES[] = { 32, 64, 128, 256, 512, 1024, 2048 };
+static const int SMALL_CLASS_COUNT = sizeof(SMALL_CLASS_SIZES) / sizeof(SMALL_CLASS_SIZES[0]);
+static const size_t SMALL_CHUNK_SIZE = 16 * 1024;
+
+static SRWLOCK g_poolLock = SRWLOCK_INIT;
+static char* g_arena = nullptr;
+static size_t g_arenaSize = 0;
+static FreeBlock* g_freeList = nullptr;
+static FreeSmallBlock* g_smallFree[SMALL_CLASS_COUNT] = {};
+
+// Statistics, guarded by g_poolLock
+static size_t g_usedBytes = 0;
+static size_t g_peakBytes = 0;
+static size_t g_cachedBytes = 0;
+static size_t g_fallbackCount = 0;
+static size_t g_fallbackBytes = 0;
+
+// FMOD arena
+static void* g_fmodArena = nullptr;
+static int g_fmodArenaSize = 0;
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool isInArena(const void* ptr) {
+    const char* p = static_cast<const char*>(ptr);
+    return g_arena != nullptr && p >= g_arena && p < g_arena + g_arenaSize;
+}
+
+static int smallClassIndex(size_t block_size) {
+    for (int i = 0; i < SMALL_CLASS_COUNT; i++) {
+        if (block_size <= SMALL_CLASS_SIZES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void writeHeader(void* block, size_t size, uint32_t tag) {
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size = size;
+    header->tag = tag;
+    header->magic = BLOCK_MAGIC;
+}
+
+// First fit from the free list, splitting the tail off the block
+// block_size is updated to the size handed out, which is the whole block when it is too small to split
+static void* allocateLarge(size_t* block_size) {
+    FreeBlock* prev = nullptr;
+    for (FreeBlock* block = g_freeList; block != nullptr; prev = block, block = block->next) {
+        size_t size = static_cast<size_t>(block->header.size);
+        if (size < *block_size) {
+            continue;
+        }
+        if (size - *block_size >= MIN_SPLIT_SIZE) {
+            // Keep the front in the list, hand out the tail
+            block->header.size = size - *block_size;
+            return reinterpret_cast<char*>(block) + (size - *block_size);
+        }
+        if (prev != nullptr) {
+            prev->next = block->next;
+        } else {
+            g_freeList = block->next;
+        }
+        *block_size = size;
+        return block;
+    }
+    return nullptr;
+}
+
+// Insert into the address ordered free list and merge with its neighbours
+static void freeLarge(void* ptr, size_t size) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    writeHeader(block, size, BLOCK_LARGE);
+
+    FreeBlock* prev = nullptr;
+    FreeBlock* next = g_freeList;
+    while (next != nullptr && next < block) {
+        prev = next;
+        next = next->next;
+    }
+
+    block->next = next;
+    if (next != nullptr && reinterpret_cast<char*>(block) + block->header.size == reinterpret_cast<char*>(next)) {
+        block->header.size += next->header.size;
+        block->next = next->next;
+    }
+
+    if (prev != nullptr) {
+        prev->next = block;
+        if (reinterpret_cast<char*>(prev) + prev->header.size == reinterpret_cast<char*>(block)) {
+            prev->header.size += block->header.size;
+            prev->next = block->next;
+        }
+    } else {
+        g_freeList = block;
+    }
+}
+
+// Take a block of the size class, carving a new chunk when the class is empty
+static void* allocateSmall(int class_index) {
+    size_t class_size = SMALL_CLASS_SIZES[class_index];
+    if (g_smallFree[class_index] == nullptr) {
+        size_t chunk_size = SMALL_CHUNK_SIZE;
+        void* chunk = allocateLarge(&chunk_size);
+        if (chunk == nullptr) {
+            return nullptr;
+        }
+        writeHeader(chunk, chunk_size, BLOCK_CHUNK);
+        // Blocks start after the chunk header so they stay 16 byte aligned
+        char* first = static_cast<char*>(chunk) + HEADER_SIZE;
+        size_t count = (SMALL_CHUNK_SIZE - HEADER_SIZE) / class_size;
+        for (size_t i = count; i > 0; i--) {
+            FreeSmallBlock* block = reinterpret_cast<FreeSmallBlock*>(first + (i - 1) * class_size);
+            block->next = g_smallFree[class_index];
+            g_smallFree[class_index] = block;
+        }
+        g_cachedBytes += count * class_size;
+    }
+
+    FreeSmallBlock* block = g_smallFree[class_index];
+    g_smallFree[class_index] = block->next;
+    g_cachedBytes -= class_size;
+    return block;
+}
+
+bool memoryPoolInitialize(size_t arena_bytes) {
+    if (arena_bytes == 0 || g_arena != nullptr) {
+        return true;
+    }
+
+    size_t size = alignUp(arena_bytes, SMALL_CHUNK_SIZE);
+    void* arena = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (arena == nullptr) {
+        return false;
+    }
+
+    AcquireSRWLockExclusive(&g_poolLock);
+    g_arena = static_cast<char*>(arena);
+    g_arenaSize = size;
+    g_freeList = static_cast<FreeBlock*>(arena);
+    writeHeader(g_freeList, size, BLOCK_LARGE);
+    g_freeList->next = nullptr;
+    for (int i = 0; i < SMALL_CLASS_COUNT; i++) {
+        g_smallFree[i] = nullptr;
+    }
+    g_usedBytes = 0;
+    g_peakBytes = 0;
+    g_cachedBytes = 0;
+    g_fallbackCount = 0;
+    ReleaseSRWLockExclusive(&g_poolLock);
+    return true;
+}
+
+void memoryPoolShutdown() {
+    AcquireSRWLockExclusive(&g_poolLock);
+    if (g_arena == nullptr) {
+        ReleaseSRWLockExclusive(&g_poolLock);
+        return;
+    }
+    if (g_usedBytes != 0) {
+        // coreFree releases everything allocated from the arena before this, so a live block is a leak
+        // in the backend; whoever owns it can still free it through poolFree, which only works while
+        // the arena is mapped, so the arena has to outlive the block and is never released
+        ReleaseSRWLockExclusive(&g_poolLock);
+        return;
+    }
+    void* arena = g_arena;
+    g_arena = nullptr;
+    g_arenaSize = 0;
+    g_freeList = nullptr;
+    for (int i = 0; i < SMALL_CLASS_COUNT; i++) {
+        g_smallFree[i] = nullptr;
+    }
+    g_peakBytes = 0;
+    g_cachedBytes = 0;
+    ReleaseSRWLockExclusive(&g_poolLock);
+
+    VirtualFree(arena, 0, MEM_RELEASE);
+}
+
+void* poolAllocate(size_t size) {
+    size_t block_size = alignUp(size + HEADER_SIZE, BLOCK_ALIGN);
+
+    AcquireSRWLockExclusive(&g_poolLock);
+    if (g_arena != nullptr) {
+        int class_index = smallClassIndex(block_size);
+        void* block = nullptr;
+        uint32_t tag = BLOCK_LARGE;
+        if (class_index >= 0) {
+            block = allocateSmall(class_index);
+            block_size = SMALL_CLASS_SIZES[class_index];
+            tag = static_cast<uint32_t>(class_index);
+        } else {
+            block = allocateLarge(&block_size);
+        }
+        if (block != nullptr) {
+            writeHeader(block, block_size, tag);
+            g_usedBytes += block_size;
+            if (g_usedBytes > g_peakBytes) {
+                g_peakBytes = g_usedBytes;
+            }
+            ReleaseSRWLockExclusive(&g_poolLock);
+            return static_cast<char*>(block) + HEADER_SIZE;
+        }
+        // Arena is full, fall through to the system heap
+        g_fallbackCount++;
+    }
+    g_fallbackBytes += block_size;
+    ReleaseSRWLockExclusive(&g_poolLock);
+
+    void* block = malloc(block_size);
+    if (block == nullptr) {
+        AcquireSRWLockExclusive(&g_poolLock);
+        g_fallbackBytes -= block_size;
+        ReleaseSRWLockExclusive(&g_poolLock);
+        return nullptr;
+    }
+    writeHeader(block, block_size, BLOCK_HEAP);
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void poolFree(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - HEADER_SIZE);
+    size_t size = static_cast<size_t>(header->size);
+
+    AcquireSRWLockExclusive(&g_poolLock);
+    if (!isInArena(header)) {
+        g_fallbackBytes -= size;
+        ReleaseSRWLockExclusive(&g_poolLock);
+        free(header);
+        return;
+    }
+
+    g_usedBytes -= size;
+    if (header->tag < static_cast<uint32_t>(SMALL_CLASS_COUNT)) {
+        FreeSmallBlock* block = reinterpret_cast<FreeSmallBlock*>(header);
+        block->next = g_smallFree[header->tag];
+        g_smallFree[header->tag] = block;
+        g_cachedBytes += size;
+    } else {
+        freeLarge(header, size);
+    }
+    ReleaseSRWLockExclusive(&g_poolLock);
+}
+
+// System heap callbacks for FMOD once its arena is gone
+static void* F_CALL fmodHeapAlloc(unsigned int size, FMOD_MEMORY_TYPE, const char*) {
+    return malloc(size);
+}
+
+static void* F_CALL fmodHeapRealloc(void* ptr, unsigned int size, FMOD_MEMORY_TYPE, const char*) {
+    return realloc(ptr, size);
+}
+
+static void F_CALL fmodHeapFree(void* ptr, FMOD_MEMORY_TYPE, const char*) {
+    free(ptr);
+}
+
+bool fmodArenaInitialize(int arena_bytes) {
+    if (arena_bytes < 0) {
+        g_context->SetLastError("Invalid FMOD arena size: " + std::to_string(arena_bytes));
+        return false;
+    }
+    if (arena_bytes == 0 || g_fmodArena != nullptr) {
+        return true;
+    }
+
+    // FMOD requires the pool length to be a multiple of 512
+    int size = static_cast<int>(alignUp(static_cast<size_t>(arena_bytes), 512));
+    void* arena = VirtualAlloc(NULL, static_cast<SIZE_T>(size), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (arena == nullptr) {
+        g_context->SetLastError("Failed to allocate FMOD memory arena");
+        return false;
+    }
+
+    FMOD_RESULT result = FMOD_Memory_Initialize(arena, size, nullptr, nullptr, nullptr, FMOD_MEMORY_ALL);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to initialize FMOD memory arena: ") + FMOD_ErrorString(result));
+        VirtualFree(arena, 0, MEM_RELEASE);
+        return false;
+    }
+
+    g_fmodArena = arena;
+    g_fmodArenaSize = size;
+    return true;
+}
+
+void fmodArenaFree() {
+    if (g_fmodArena == nullptr) {
+        return;
+    }
+
+    // FMOD frees its global state lazily, so anything it still holds would point into the arena
+    int current_bytes = 0;
+    int peak_bytes = 0;
+    if (FMOD_Memory_GetStats(&current_bytes, &peak_bytes, false) != FMOD_OK || current_bytes != 0) {
+        return;
+    }
+    // FMOD_Memory_Initialize needs either a pool or all three callbacks, so the system heap is handed
+    // over through callbacks; this is only allowed while no FMOD system exists
+    if (FMOD_Memory_Initialize(nullptr, 0, fmodHeapAlloc, fmodHeapRealloc, fmodHeapFree, FMOD_MEMORY_ALL) != FMOD_OK) {
+        return;
+    }
+    VirtualFree(g_fmodArena, 0, MEM_RELEASE);
+    g_fmodArena = nullptr;
+    g_fmodArenaSize = 0;
+}
+
+extern "C" {
+
+// Get the usage of the FMOD and backend arenas
+int coreGetMemoryStats(AudioMemoryStats* stats) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (stats == nullptr) {
+        g_context->SetLastError("Invalid parameter: stats cannot be null");
+        return -1;
+    }
+
+    *stats = AudioMemoryStats();
+    stats->fmod_arena_bytes = g_fmodArenaSize;
+    FMOD_Memory_GetStats(&stats->fmod_current_bytes, &stats->fmod_peak_bytes, false);
+
+    AcquireSRWLockShared(&g_poolLock);
+    size_t free_bytes = 0;
+    size_t largest = 0;
+    for (FreeBlock* block = g_freeList; block != nullptr; block = block->next) {
+        size_t size = static_cast<size_t>(block->header.size);
+        free_bytes += size;
+        if (size > largest) {
+            largest = size;
+        }
+    }
+    stats->backend_arena_bytes = static_cast<int>(g_arenaSize);
+    stats->backend_used_bytes = static_cast<int>(g_usedBytes);
+    stats->backend_peak_bytes = static_cast<int>(g_peakBytes);
+    stats->backend_cached_bytes = static_cast<int>(g_cachedBytes);
+    stats->backend_free_bytes = static_cast<int>(free_bytes);
+    stats->backend_largest_free_bytes = static_cast<int>(largest);
+    stats->backend_fragmentation = free_bytes > 0 ? 1.0f - static_cast<float>(largest) / static_cast<float>(free_bytes) : 0.0f;
+    stats->backend_fallback_count = static_cast<int>(g_fallbackCount);
+    stats->backend_fallback_bytes = static_cast<int>(g_fallbackBytes);
+    ReleaseSRWLockShared(&g_poolLock);
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,106 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include "hash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Memory usage of the FMOD arena and the backend arena
+typedef struct {
+    // FMOD arena (FMOD_Memory_Initialize), 0 when FMOD uses the system heap
+    int fmod_arena_bytes;
+    int fmod_current_bytes;
+    int fmod_peak_bytes;
+    // Backend arena, 0 when the backend uses the system heap
+    int backend_arena_bytes;
+    int backend_used_bytes;          // Live allocations, including block headers
+    int backend_peak_bytes;          // High-water mark of backend_used_bytes
+    int backend_cached_bytes;        // Freed small blocks kept for reuse
+    int backend_free_bytes;          // Unallocated arena bytes
+    int backend_largest_free_bytes;  // Largest single free range
+    float backend_fragmentation;     // 1 - largest free / free, 0 when the free space is contiguous
+    int backend_fallback_count;      // Allocations that went to the system heap because the arena was full
+    int backend_fallback_bytes;      // Live bytes on the system heap
+} AudioMemoryStats;
+
+int coreGetMemoryStats(AudioMemoryStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Set up the backend arena. 0 bytes keeps the system heap.
+// Only an arena that memoryPoolShutdown had to keep is reused.
+bool memoryPoolInitialize(size_t arena_bytes);
+// Release the backend arena. A block still allocated from it is a leak, and the arena is kept
+// for the rest of the process so that block never points at unmapped memory.
+void memoryPoolShutdown();
+
+// Allocate from the backend arena, falling back to the system heap when it is full
+// Returns null only if the system heap is exhausted as well
+void* poolAllocate(size_t size);
+// Free memory from poolAllocate, ptr can be null
+void poolFree(void* ptr);
+
+// Hand FMOD a preallocated arena (FMOD_Memory_Initialize), must be called before System_Create
+// Returns false and sets the last error on failure
+bool fmodArenaInitialize(int arena_bytes);
+// Point FMOD back at the system heap and release its arena, after the FMOD system has been released
+// Kept (and reused by fmodArenaInitialize) while FMOD still holds memory in it
+void fmodArenaFree();
+
+// Standard allocator on top of poolAllocate / poolFree
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+
+    PoolAllocator() noexcept {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        void* ptr = poolAllocate(n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        poolFree(ptr);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return false;
+}
+
+// String allocated from the backend arena
+typedef std::basic_string<char, std::char_traits<char>, PoolAllocator<char>> PoolString;
+
+// std::hash has no specialization for strings with a custom allocator
+struct PoolStringHash {
+    size_t operator()(const PoolString& str) const {
+        return static_cast<size_t>(hashFnv1a(str.data(), str.size()));
+    }
+};
+
+// String keyed map allocated from the backend arena
+template <typename V>
+using PoolStringMap = std::unordered_map<PoolString, V, PoolStringHash, std::equal_to<PoolString>, PoolAllocator<std::pair<const PoolString, V>>>;
+
+#endif // MEMORY_POOL_H
@@ -0,0 +1,341 @@
+#include "music_group.h"
+#include "bgm.h"
+#include "bgm_playlist.h"
+#include "context.h"
+#include "fmod/fmod.hpp"
+#include "fmod/fmod_errors.h"
+#include <climits>
+#include <string>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+// Group index of a live music group handle, or -1 (sets the last error)
+static int getMusicGroupIndex(int handle) {
+    auto& groups = g_context->GetMusicGroups();
+    size_t index = static_cast<size_t>(handle & BGM_HANDLE_INDEX_MASK);
+    unsigned int generation = static_cast<unsigned int>(handle >> BGM_HANDLE_INDEX_BITS) & BGM_HANDLE_GENERATION_MASK;
+    if ((handle & MUSIC_GROUP_HANDLE_BIT) == 0 || index >= groups.size() || !groups[index].is_used || groups[index].generation != generation) {
+        g_context->SetLastError("Invalid music group handle: " + std::to_string(handle));
+        return -1;
+    }
+    return static_cast<int>(index);
+}
+
+// Resolve every layer of a group, false (sets the last error) if one of them was freed
+static bool resolveLayers(const MusicGroup& group, BgmSlot** layers) {
+    for (int i = 0; i < group.count; i++) {
+        layers[i] = resolveBgmSlot(group.layers[i]);
+        if (layers[i] == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Layer volume at a DSP clock, following its ramp
+static float layerVolumeAt(const MusicGroup& group, int layer, unsigned long long clock) {
+    if (clock >= group.ramp_end[layer]) {
+        return group.volumes[layer];
+    }
+    if (clock <= group.ramp_start[layer]) {
+        return group.ramp_from[layer];
+    }
+    double t = static_cast<double>(clock - group.ramp_start[layer]) / static_cast<double>(group.ramp_end[layer] - group.ramp_start[layer]);
+    return group.ramp_from[layer] + static_cast<float>((group.volumes[layer] - group.ramp_from[layer]) * t);
+}
+
+// Loop points that keep the layers in phase: each layer's own, with the loop end cut to the shortest layer
+// so all layers wrap on the same sample. They are set on the group's channels, the sounds keep their own.
+// Returns false (sets the last error) if the layers can't stay in phase
+static bool getAlignedLoopPoints(BgmSlot** layers, int count, unsigned int* loop_starts, unsigned int* loop_ends) {
+    float first_frequency = 0.0f;
+    unsigned int shortest = UINT_MAX;
+    for (int i = 0; i < count; i++) {
+        float frequency = 0.0f;
+        unsigned int length = 0;
+        layers[i]->sound->getDefaults(&frequency, nullptr);
+        FMOD_RESULT result = layers[i]->sound->getLength(&length, FMOD_TIMEUNIT_PCM);
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to get BGM length: ") + FMOD_ErrorString(result));
+            return false;
+        }
+        if (i == 0) {
+            first_frequency = frequency;
+        } else if (frequency != first_frequency) {
+            g_context->SetLastError("Music group layers have different sample rates: " + std::to_string(first_frequency) + " and " + std::to_string(frequency));
+            return false;
+        }
+        if (length < shortest) {
+            shortest = length;
+        }
+    }
+    if (shortest == 0) {
+        g_context->SetLastError("Music group layer is empty");
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        loop_starts[i] = 0;
+        loop_ends[i] = 0;
+        layers[i]->sound->getLoopPoints(&loop_starts[i], FMOD_TIMEUNIT_PCM, &loop_ends[i], FMOD_TIMEUNIT_PCM);
+        if (loop_ends[i] < shortest) {
+            continue;
+        }
+        loop_ends[i] = shortest - 1;
+        if (loop_starts[i] >= loop_ends[i]) {
+            loop_starts[i] = 0;
+        }
+    }
+    return true;
+}
+
+int musicGroupCreate(const int* slots, int count) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (slots == nullptr) {
+        g_context->SetLastError("Invalid parameter: slots cannot be null");
+        return -1;
+    }
+    if (count <= 0 || count > MUSIC_GROUP_MAX_LAYERS) {
+        g_context->SetLastError("Invalid music group size: " + std::to_string(count) + " (1 - " + std::to_string(MUSIC_GROUP_MAX_LAYERS) + ")");
+        return -1;
+    }
+
+    // A slot has one channel, so it can't be two layers
+    for (int i = 0; i < count; i++) {
+        if (resolveBgmSlot(slots[i]) == nullptr) {
+            return -1;
+        }
+        for (int j = 0; j < i; j++) {
+            if (slots[j] == slots[i]) {
+                g_context->SetLastError("BGM handle is in the music group twice: " + std::to_string(slots[i]));
+                return -1;
+            }
+        }
+    }
+
+    auto& groups = g_context->GetMusicGroups();
+    int index = -1;
+    for (size_t i = 0; i < groups.size(); i++) {
+        if (!groups[i].is_used) {
+            index = static_cast<int>(i);
+            break;
+        }
+    }
+    if (index < 0) {
+        if (groups.size() > static_cast<size_t>(BGM_HANDLE_INDEX_MASK)) {
+            g_context->SetLastError("Too many music groups");
+            return -1;
+        }
+        groups.push_back(MusicGroup());
+        index = static_cast<int>(groups.size() - 1);
+    }
+
+    MusicGroup& group = groups[index];
+    unsigned int generation = (group.generation % BGM_HANDLE_GENERATION_MASK) + 1;
+    group = MusicGroup();
+    group.generation = generation;
+    group.is_used = true;
+    group.count = count;
+    for (int i = 0; i < count; i++) {
+        group.layers[i] = slots[i];
+        group.volumes[i] = 1.0f;
+        group.ramp_from[i] = 1.0f;
+    }
+
+    return MUSIC_GROUP_HANDLE_BIT | static_cast<int>(generation << BGM_HANDLE_INDEX_BITS) | index;
+}
+
+int musicGroupFree(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    int index = getMusicGroupIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    MusicGroup& group = g_context->GetMusicGroups()[index];
+    unsigned int generation = group.generation;
+    group = MusicGroup();
+    group.generation = generation;
+    return 0;
+}
+
+int musicGroupPlay(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    int index = getMusicGroupIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    MusicGroup& group = g_context->GetMusicGroups()[index];
+    BgmSlot* layers[MUSIC_GROUP_MAX_LAYERS] = {};
+    if (!resolveLayers(group, layers)) {
+        return -1;
+    }
+    for (int i = 0; i < group.count; i++) {
+        if (!checkBgmReady(layers[i]) || !checkBgmSlotOutsidePlaylist(group.layers[i])) {
+            return -1;
+        }
+    }
+    unsigned int loop_starts[MUSIC_GROUP_MAX_LAYERS] = {};
+    unsigned int loop_ends[MUSIC_GROUP_MAX_LAYERS] = {};
+    if (!getAlignedLoopPoints(layers, group.count, loop_starts, loop_ends)) {
+        return -1;
+    }
+
+    // Everything that can fail comes before the running layers are stopped
+    unsigned long long start_clock = 0;
+    if (!getBgmStartClock(&start_clock)) {
+        return -1;
+    }
+
+    for (int i = 0; i < group.count; i++) {
+        if (layers[i]->channel != nullptr) {
+            layers[i]->channel->stop();
+            layers[i]->channel = nullptr;
+        }
+    }
+
+    // Every layer is created paused and held by setDelay until the shared clock,
+    // so they start in the same mixer block at the same sample
+    FMOD::System* system = g_context->GetFmodSystem();
+    FMOD::ChannelGroup* bgmGroup = g_context->GetBgmChannelGroup();
+    FMOD::Channel* channels[MUSIC_GROUP_MAX_LAYERS] = {};
+    for (int i = 0; i < group.count; i++) {
+        FMOD_RESULT result = system->playSound(layers[i]->sound, bgmGroup, true, &channels[i]);
+        if (result == FMOD_OK) {
+            result = channels[i]->setLoopPoints(loop_starts[i], FMOD_TIMEUNIT_PCM, loop_ends[i], FMOD_TIMEUNIT_PCM);
+        }
+        if (result == FMOD_OK) {
+            result = channels[i]->setDelay(start_clock, 0, true);
+        }
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to schedule music group layer: ") + FMOD_ErrorString(result));
+            for (int j = 0; j <= i; j++) {
+                if (channels[j] != nullptr) {
+                    channels[j]->stop();
+                }
+            }
+            return -1;
+        }
+
+        // Layer volumes are fade points, so ramps can start from wherever the previous one was
+        channels[i]->addFadePoint(start_clock, group.volumes[i]);
+        group.ramp_from[i] = group.volumes[i];
+        group.ramp_start[i] = start_clock;
+        group.ramp_end[i] = start_clock;
+    }
+
+    for (int i = 0; i < group.count; i++) {
+        channels[i]->setPaused(false);
+        layers[i]->channel = channels[i];
+        layers[i]->is_paused = false;
+    }
+    return 0;
+}
+
+int musicGroupStop(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    int index = getMusicGroupIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    MusicGroup& group = g_context->GetMusicGroups()[index];
+    for (int i = 0; i < group.count; i++) {
+        if (bgmStop(group.layers[i]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int musicGroupSetLayerVolume(int handle, int layer, float volume, int ms) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    int index = getMusicGroupIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    MusicGroup& group = g_context->GetMusicGroups()[index];
+    if (layer < 0 || layer >= group.count) {
+        g_context->SetLastError("Invalid music group layer: " + std::to_string(layer) + " (0 - " + std::to_string(group.count - 1) + ")");
+        return -1;
+    }
+    if (volume < 0.0f || ms < 0) {
+        g_context->SetLastError("Invalid parameters: volume and ms cannot be negative");
+        return -1;
+    }
+
+    BgmSlot* bgm = resolveBgmSlot(group.layers[layer]);
+    if (bgm == nullptr) {
+        return -1;
+    }
+    if (bgm->channel == nullptr) {
+        // Not playing, the next musicGroupPlay starts at it
+        group.volumes[layer] = volume;
+        group.ramp_from[layer] = volume;
+        return 0;
+    }
+
+    unsigned long long now = 0;
+    FMOD_RESULT result = bgm->channel->getDSPClock(nullptr, &now);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to get DSP clock: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+    int rate = 0;
+    g_context->GetFmodSystem()->getSoftwareFormat(&rate, nullptr, nullptr);
+
+    // A layer started by musicGroupPlay may still be waiting for its start clock
+    unsigned long long ramp_start = now > group.ramp_start[layer] ? now : group.ramp_start[layer];
+    unsigned long long ramp_length = static_cast<unsigned long long>(ms) * rate / 1000;
+    float from = layerVolumeAt(group, layer, ramp_start);
+
+    // Replace what is left of the previous ramp, from the volume it had reached
+    bgm->channel->removeFadePoints(ramp_start, ULLONG_MAX);
+    if (ramp_length > 0) {
+        bgm->channel->addFadePoint(ramp_start, from);
+    }
+    result = bgm->channel->addFadePoint(ramp_start + ramp_length, volume);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to ramp music group layer: ") + FMOD_ErrorString(result));
+        return -1;
+    }
+
+    group.volumes[layer] = volume;
+    group.ramp_from[layer] = from;
+    group.ramp_start[layer] = ramp_start;
+    group.ramp_end[layer] = ramp_start + ramp_length;
+    return 0;
+}
+
+int musicGroupSetLoopPoint(int handle, int ms) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+    int index = getMusicGroupIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    MusicGroup& group = g_context->GetMusicGroups()[index];
+    for (int i = 0; i < group.count; i++) {
+        if (bgmSetLoopPoint(group.layers[i], ms) != 0) {
+            return -1;
+        }
+    }
+    // bgmSetLoopPoint loops each layer at its own end, musicGroupPlay cuts them to the shortest on its channels
+    return 0;
+}
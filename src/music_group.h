@@ -0,0 +1,23 @@
+#ifndef MUSIC_GROUP_H
+#define MUSIC_GROUP_H
+
+// Music groups play BGM slots as layers (stems) of one piece, started on the same DSP clock
+// Handles: bits 0-15 group index, bits 16-29 generation, bit 30 set (MUSIC_GROUP_HANDLE_BIT)
+const int MUSIC_GROUP_MAX_LAYERS = 8;
+
+// Returns the group handle (> 0), or -1 on failure
+// The slots stay owned by the caller, freeing one makes the group's calls fail until it is freed
+int musicGroupCreate(const int* slots, int count);
+int musicGroupFree(int group);
+
+// Start every layer from the beginning at one shared DSP clock
+int musicGroupPlay(int group);
+int musicGroupStop(int group);
+
+// Ramp one layer's volume over ms, the volume is also used by the next musicGroupPlay
+int musicGroupSetLayerVolume(int group, int layer, float volume, int ms);
+
+// Set the same loop point on every layer
+int musicGroupSetLoopPoint(int group, int ms);
+
+#endif // MUSIC_GROUP_H
@@ -0,0 +1,153 @@
+#include "pcm_cache.h"
+#include "context.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <Windows.h>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+static const char PCM_CACHE_MAGIC[4] = {'A', 'P', 'C', 'M'};
+static const uint32_t PCM_CACHE_VERSION = 2;
+// PCM starts on a page boundary of the mapping
+static const uint64_t PCM_DATA_OFFSET = 4096;
+
+struct PcmCacheHeader {
+    char magic[4];  // "APCM"
+    uint32_t version;
+    uint64_t source_hash;
+    int32_t source_size;
+    int32_t target_rate;  // PcmCacheKey::rate
+    int32_t target_channels;  // PcmCacheKey::channels
+    uint32_t processing;  // PcmCacheKey::processing
+    int32_t format;  // FMOD_SOUND_FORMAT of the data
+    int32_t channels;
+    int32_t frequency;
+    uint64_t data_offset;
+    uint64_t data_bytes;
+    SampleLoudness loudness;  // Analysis done before the PCM was stored
+};
+
+static std::string cachePath(const std::string& directory, const PcmCacheKey& key) {
+    char name[128];
+    snprintf(name, sizeof(name), "%016llx_%d_%d_%d_%08x.pcm", static_cast<unsigned long long>(key.source_hash),
+        key.source_size, key.rate, key.channels, key.processing);
+    std::string path = directory;
+    if (!path.empty() && path.back() != '/' && path.back() != '\\') {
+        path += '/';
+    }
+    return path + name;
+}
+
+static bool isPcmFormat(int format) {
+    return format >= FMOD_SOUND_FORMAT_PCM8 && format <= FMOD_SOUND_FORMAT_PCMFLOAT;
+}
+
+FMOD::Sound* openCachedPcm(const std::string& directory, const PcmCacheKey& key, MappedFile* mapped, SampleLoudness* loudness) {
+    std::string error;
+    std::string path = cachePath(directory, key);
+    if (!mapFile(path.c_str(), mapped, &error)) {
+        return nullptr;
+    }
+
+    // The name already encodes the key, the header guards against hash collisions and torn files
+    PcmCacheHeader header;
+    bool valid = mapped->size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, mapped->data, sizeof(header));
+        valid = memcmp(header.magic, PCM_CACHE_MAGIC, sizeof(PCM_CACHE_MAGIC)) == 0 &&
+            header.version == PCM_CACHE_VERSION && header.source_hash == key.source_hash &&
+            header.source_size == key.source_size && header.target_rate == key.rate &&
+            header.target_channels == key.channels && header.processing == key.processing && isPcmFormat(header.format) &&
+            header.channels > 0 && header.frequency > 0 && header.data_bytes > 0 &&
+            header.data_offset <= mapped->size && header.data_bytes <= mapped->size - header.data_offset &&
+            header.data_bytes <= 0xffffffffULL;
+    }
+    if (!valid) {
+        unmapFile(mapped);
+        return nullptr;
+    }
+
+    FMOD_CREATESOUNDEXINFO exinfo = {};
+    exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+    exinfo.length = static_cast<unsigned int>(header.data_bytes);
+    exinfo.numchannels = header.channels;
+    exinfo.defaultfrequency = header.frequency;
+    exinfo.format = static_cast<FMOD_SOUND_FORMAT>(header.format);
+
+    // Nothing to decode: FMOD plays the mapped PCM as it is
+    FMOD::Sound* sound = nullptr;
+    const char* data = static_cast<const char*>(mapped->data) + header.data_offset;
+    FMOD_RESULT result = g_context->GetFmodSystem()->createSound(data, FMOD_OPENMEMORY_POINT | FMOD_OPENRAW | FMOD_CREATESAMPLE, &exinfo, &sound);
+    if (result != FMOD_OK) {
+        unmapFile(mapped);
+        return nullptr;
+    }
+    *loudness = header.loudness;
+    return sound;
+}
+
+bool storeCachedPcm(const std::string& directory, const PcmCacheKey& key, FMOD::Sound* sound, const SampleLoudness& loudness) {
+    FMOD_SOUND_FORMAT format = FMOD_SOUND_FORMAT_NONE;
+    int channels = 0;
+    float frequency = 0.0f;
+    unsigned int data_bytes = 0;
+    sound->getFormat(nullptr, &format, &channels, nullptr);
+    sound->getDefaults(&frequency, nullptr);
+    sound->getLength(&data_bytes, FMOD_TIMEUNIT_PCMBYTES);
+    if (!isPcmFormat(format) || channels <= 0 || data_bytes == 0) {
+        return false;
+    }
+
+    PcmCacheHeader header = {};
+    memcpy(header.magic, PCM_CACHE_MAGIC, sizeof(PCM_CACHE_MAGIC));
+    header.version = PCM_CACHE_VERSION;
+    header.source_hash = key.source_hash;
+    header.source_size = key.source_size;
+    header.target_rate = key.rate;
+    header.target_channels = key.channels;
+    header.processing = key.processing;
+    header.format = format;
+    header.channels = channels;
+    header.frequency = static_cast<int32_t>(frequency);
+    header.data_offset = PCM_DATA_OFFSET;
+    header.data_bytes = data_bytes;
+    header.loudness = loudness;
+
+    void* ptr1 = nullptr;
+    void* ptr2 = nullptr;
+    unsigned int len1 = 0;
+    unsigned int len2 = 0;
+    if (sound->lock(0, data_bytes, &ptr1, &ptr2, &len1, &len2) != FMOD_OK) {
+        return false;
+    }
+
+    // Written under a temporary name and renamed, so a crash never leaves a torn file under the real name
+    std::string path = cachePath(directory, key);
+    std::string temp_path = path + ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (file.is_open()) {
+            std::vector<char> page(static_cast<size_t>(PCM_DATA_OFFSET), 0);
+            memcpy(page.data(), &header, sizeof(header));
+            file.write(page.data(), static_cast<std::streamsize>(page.size()));
+            file.write(static_cast<const char*>(ptr1), len1);
+            if (ptr2 != nullptr && len2 > 0) {
+                file.write(static_cast<const char*>(ptr2), len2);
+            }
+            written = static_cast<bool>(file);
+        }
+    }
+    sound->unlock(ptr1, ptr2, len1, len2);
+
+    // Replaces a stale file that failed validation; another process may have stored the same file
+    // in the meantime (or still have it mapped), either copy is fine
+    if (!written || !MoveFileExA(temp_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
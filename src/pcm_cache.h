@@ -0,0 +1,31 @@
+#ifndef PCM_CACHE_H
+#define PCM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include "fmod/fmod.hpp"
+#include "mapped_file.h"
+#include "sample.h"
+
+// On-disk cache of decoded sample PCM, one file per source:
+// <directory>/<content hash>_<source size>_<rate>_<channels>_<processing>.pcm
+// rate and channels are the format the PCM was converted to at load time, 0 for as decoded
+struct PcmCacheKey {
+    uint64_t source_hash;  // hashBytes64 of the encoded source
+    int source_size;
+    int rate;
+    int channels;
+    uint32_t processing;  // Hash of the load options that change the PCM (trim, normalize)
+};
+
+// Open the cached PCM of a source in place (FMOD_OPENRAW | FMOD_OPENMEMORY_POINT)
+// The mapping has to outlive the sound, unmap it after releasing the sound
+// loudness gets the analysis stored with the PCM
+// Returns null on a miss, or if the cache file doesn't match the key; doesn't set the last error
+FMOD::Sound* openCachedPcm(const std::string& directory, const PcmCacheKey& key, MappedFile* mapped, SampleLoudness* loudness);
+
+// Write the PCM of a decoded sample to the cache, false if it could not be written
+// Best effort: a failure only means the next launch decodes again
+bool storeCachedPcm(const std::string& directory, const PcmCacheKey& key, FMOD::Sound* sound, const SampleLoudness& loudness);
+
+#endif // PCM_CACHE_H
@@ -0,0 +1,193 @@
+#include "render.h"
+#include "context.h"
+#include "stats.h"
+#include "bgm_playlist.h"
+#include "fmod/fmod.hpp"
+#include "fmod/fmod_dsp.h"
+#include "fmod/fmod_errors.h"
+#include <cstring>
+#include <vector>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+// Capture DSP on the head of the master channel group
+static FMOD::DSP* g_captureDsp = nullptr;
+// Mixed output not handed to the caller yet (interleaved)
+// The NRT mixer runs inside System::update on the calling thread, so no locking is needed
+static std::vector<float> g_captured;
+static size_t g_capturedRead = 0;
+static int g_captureChannels = 0;
+
+// Pass the mix through unchanged and keep a copy of it
+static FMOD_RESULT F_CALL captureRead(FMOD_DSP_STATE*, float* inbuffer, float* outbuffer, unsigned int length, int inchannels, int* outchannels) {
+    size_t samples = static_cast<size_t>(length) * inchannels;
+    memcpy(outbuffer, inbuffer, samples * sizeof(float));
+    *outchannels = inchannels;
+
+    g_captureChannels = inchannels;
+    g_captured.insert(g_captured.end(), inbuffer, inbuffer + samples);
+    return FMOD_OK;
+}
+
+// Always process, so silent blocks are captured as well
+static FMOD_RESULT F_CALL captureShouldProcess(FMOD_DSP_STATE*, FMOD_BOOL, unsigned int, FMOD_CHANNELMASK, int, FMOD_SPEAKERMODE) {
+    return FMOD_OK;
+}
+
+bool isNonRealtimeOutput(int output_type) {
+    return output_type == FMOD_OUTPUTTYPE_NOSOUND_NRT || output_type == FMOD_OUTPUTTYPE_WAVWRITER_NRT;
+}
+
+bool startRenderCapture(FMOD::System* system) {
+    FMOD_DSP_DESCRIPTION desc = {};
+    desc.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+    static const char name[] = "audiobackend capture";
+    memcpy(desc.name, name, sizeof(name));
+    desc.numinputbuffers = 1;
+    desc.numoutputbuffers = 1;
+    desc.read = captureRead;
+    desc.shouldiprocess = captureShouldProcess;
+
+    FMOD::DSP* dsp = nullptr;
+    FMOD_RESULT result = system->createDSP(&desc, &dsp);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to create capture DSP: ") + FMOD_ErrorString(result));
+        return false;
+    }
+
+    FMOD::ChannelGroup* masterGroup = nullptr;
+    result = system->getMasterChannelGroup(&masterGroup);
+    if (result == FMOD_OK) {
+        // Head is the output end of the chain, so the capture sees the final mix
+        result = masterGroup->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp);
+    }
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to attach capture DSP: ") + FMOD_ErrorString(result));
+        dsp->release();
+        return false;
+    }
+
+    g_captureDsp = dsp;
+    g_captured.clear();
+    g_capturedRead = 0;
+    g_captureChannels = 0;
+    return true;
+}
+
+void stopRenderCapture() {
+    if (g_captureDsp == nullptr) {
+        return;
+    }
+
+    FMOD::ChannelGroup* masterGroup = nullptr;
+    if (g_context->GetFmodSystem()->getMasterChannelGroup(&masterGroup) == FMOD_OK) {
+        masterGroup->removeDSP(g_captureDsp);
+    }
+    g_captureDsp->release();
+    g_captureDsp = nullptr;
+
+    std::vector<float>().swap(g_captured);
+    g_capturedRead = 0;
+    g_captureChannels = 0;
+}
+
+extern "C" {
+
+// Advance the non-realtime mixer by exactly the requested number of frames
+int coreRenderFrames(int frames, float* buffer, int buffer_length) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (g_captureDsp == nullptr) {
+        g_context->SetLastError("Render is only available when initialized with a non-realtime output type");
+        return -1;
+    }
+
+    if (frames < 0) {
+        g_context->SetLastError("Invalid frame count");
+        return -1;
+    }
+
+    // Reject a buffer that can't hold the frames before mixing them; the channel count
+    // is known once the capture has seen a block, the first call checks after the mix
+    if (buffer != nullptr && buffer_length < 0) {
+        g_context->SetLastError("Invalid buffer length");
+        return -1;
+    }
+    if (buffer != nullptr && g_captureChannels != 0 && static_cast<size_t>(buffer_length) < static_cast<size_t>(frames) * g_captureChannels) {
+        g_context->SetLastError("Buffer is too small: need " + std::to_string(static_cast<size_t>(frames) * g_captureChannels) + " floats");
+        return -1;
+    }
+
+    FMOD::System* system = g_context->GetFmodSystem();
+
+    // Each update mixes one DSP block; keep the remainder for the next call
+    while (g_captureChannels == 0 || (g_captured.size() - g_capturedRead) < static_cast<size_t>(frames) * g_captureChannels) {
+        size_t before = g_captured.size();
+        drainCommandQueue(g_context->GetCommandQueue(), system);
+        FMOD_RESULT result = system->update();
+        if (result != FMOD_OK) {
+            g_context->SetLastError(std::string("Failed to update FMOD system: ") + FMOD_ErrorString(result));
+            return -1;
+        }
+        updateBgmPlaylists(system);
+        if (g_captured.size() == before) {
+            g_context->SetLastError("Mixer did not produce any output");
+            return -1;
+        }
+    }
+    refreshStatsSnapshot(system);
+
+    size_t samples = static_cast<size_t>(frames) * g_captureChannels;
+    if (buffer != nullptr) {
+        if (buffer_length < 0 || static_cast<size_t>(buffer_length) < samples) {
+            g_context->SetLastError("Buffer is too small: need " + std::to_string(samples) + " floats");
+            return -1;
+        }
+        memcpy(buffer, g_captured.data() + g_capturedRead, samples * sizeof(float));
+    }
+    g_capturedRead += samples;
+
+    // Compact once the consumed part dominates the buffer
+    if (g_capturedRead > g_captured.size() / 2) {
+        g_captured.erase(g_captured.begin(), g_captured.begin() + g_capturedRead);
+        g_capturedRead = 0;
+    }
+
+    return frames;
+}
+
+// Get the sample rate and channel count of the rendered output
+int coreGetRenderFormat(int* sample_rate, int* channels) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (g_captureDsp == nullptr) {
+        g_context->SetLastError("Render is only available when initialized with a non-realtime output type");
+        return -1;
+    }
+
+    int rate = 0;
+    FMOD_SPEAKERMODE speaker_mode = FMOD_SPEAKERMODE_DEFAULT;
+    int raw_speakers = 0;
+    FMOD::System* system = g_context->GetFmodSystem();
+    system->getSoftwareFormat(&rate, &speaker_mode, &raw_speakers);
+
+    if (sample_rate != nullptr) {
+        *sample_rate = rate;
+    }
+    if (channels != nullptr) {
+        // Before the first block is mixed, derive the count from the speaker mode
+        int count = g_captureChannels;
+        if (count == 0) {
+            system->getSpeakerModeChannels(speaker_mode, &count);
+        }
+        *channels = count;
+    }
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,30 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "fmod/fmod.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Advance the non-realtime mixer by exactly frames sample frames.
+// If buffer is not null, the interleaved float output is written to it;
+// buffer_length is its size in floats and must hold frames * channels.
+// Returns the number of frames rendered, or -1 on failure.
+int coreRenderFrames(int frames, float* buffer, int buffer_length);
+
+// Get the sample rate and channel count of the rendered output
+int coreGetRenderFormat(int* sample_rate, int* channels);
+
+#ifdef __cplusplus
+}
+#endif
+
+// True if the output type renders only when the backend drives the mixer
+bool isNonRealtimeOutput(int output_type);
+
+// Attach / detach the capture DSP on the master channel group
+bool startRenderCapture(FMOD::System* system);
+void stopRenderCapture();
+
+#endif // RENDER_H
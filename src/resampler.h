@@ -0,0 +1,16 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+// Windowed-sinc (Kaiser) sample rate converter for converting samples once at load time
+// Band-limits to the lower of the two rates, so downsampling doesn't alias
+
+// Number of frames resampleInterleaved produces
+size_t resampledFrameCount(size_t frames, int in_rate, int out_rate);
+
+// Convert interleaved float PCM from in_rate to out_rate, output is interleaved as well
+void resampleInterleaved(const float* input, size_t frames, int channels, int in_rate, int out_rate, std::vector<float>* output);
+
+#endif // RESAMPLER_H
@@ -1,64 +1,1314 @@
 #include "sample.h"
+#include "sample_group.h"
 #include "context.h"
+#include "hash.h"
+#include "bank.h"
+#include "pcm_cache.h"
+#include "resampler.h"
+#include "sample_analysis.h"
 #include "fmod/fmod.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <thread>
+#include <Windows.h>
 
 extern AudioBackendContext* g_context;
 
+// A oneshot is assumed to still be playing for twice its length plus this margin,
+// which covers pitches down to 0.5
+static const unsigned long long BUSY_MARGIN_MS = 100;
+
+// Attributes a oneshot without attributes plays with (center, 100% volume and pitch)
+static const SoundAttributes DEFAULT_ATTRIBUTES = {0.0f, 1.0f, 1.0f};
+
+// FMOD runs FMOD_NONBLOCKING opens on up to 5 threads (nonblockthreadid 0-4)
+static const int MAX_ASYNC_LOAD_THREADS = 5;
+// Auto load mode: samples at least this long are kept compressed
+static const int DEFAULT_AUTO_MIN_LENGTH_MS = 10000;
+// Auto load mode: a sample limited to more instances than this overlaps too much to stay compressed
+static const int AUTO_MAX_INSTANCES = 2;
+
+// Load-time analysis defaults (SampleLoadOptions), and the limits of trimming and normalization
+static const float DEFAULT_SILENCE_THRESHOLD_DB = -60.0f;
+static const float DEFAULT_TARGET_LUFS = -18.0f;
+static const size_t TRIM_MARGIN_MS = 1;
+static const float NORMALIZE_PEAK_CEILING = 0.891f;  // -1 dBFS
+
+// Thread the next asynchronous load goes to, loads are spread round-robin
+static int g_nextLoadThread = 0;
+
+static int makeSampleHandle(int index, unsigned int generation) {
+    return static_cast<int>(generation << SAMPLE_HANDLE_INDEX_BITS) | index;
+}
+
+// Slot index of a live handle, or -1 (sets the last error)
+static int getSampleIndex(int handle) {
+    auto& slots = g_context->GetSampleSlots();
+    size_t index = static_cast<size_t>(handle & SAMPLE_HANDLE_INDEX_MASK);
+    unsigned int generation = static_cast<unsigned int>(handle >> SAMPLE_HANDLE_INDEX_BITS) & SAMPLE_HANDLE_GENERATION_MASK;
+    if (handle <= 0 || (handle & SAMPLE_HANDLE_GROUP_BIT) != 0 || index >= slots.size() || !slots[index].is_used || slots[index].generation != generation) {
+        g_context->SetLastError("Invalid sample handle: " + std::to_string(handle));
+        return -1;
+    }
+    return static_cast<int>(index);
+}
+
+// Find the slot of a sample by key, -1 (sets the last error) if not found
+static int findSampleIndex(const char* key) {
+    if (key == nullptr) {
+        g_context->SetLastError("Invalid parameter: key cannot be null");
+        return -1;
+    }
+
+    int handle = findSampleHandle(key);
+    if (handle < 0) {
+        return -1;
+    }
+    if ((handle & SAMPLE_HANDLE_GROUP_BIT) != 0) {
+        g_context->SetLastError(std::string("Not a sample but a sound group: ") + key);
+        return -1;
+    }
+    return handle & SAMPLE_HANDLE_INDEX_MASK;
+}
+
+// Slot holding the voice settings of a sample, the owner for shared sounds
+static int ownerSlot(int index) {
+    int owner = g_context->GetSampleSlots()[index].shared_owner;
+    return owner >= 0 ? owner : index;
+}
+
+bool isValidSampleHandle(int handle) {
+    auto& slots = g_context->GetSampleSlots();
+    size_t index = static_cast<size_t>(handle & SAMPLE_HANDLE_INDEX_MASK);
+    unsigned int generation = static_cast<unsigned int>(handle >> SAMPLE_HANDLE_INDEX_BITS) & SAMPLE_HANDLE_GENERATION_MASK;
+    return handle > 0 && (handle & SAMPLE_HANDLE_GROUP_BIT) == 0 && index < slots.size() && slots[index].is_used && slots[index].generation == generation;
+}
+
+static void lruRemove(int index) {
+    auto& slots = g_context->GetSampleSlots();
+    SampleCache& cache = g_context->GetSampleCache();
+    SampleSlot& slot = slots[index];
+    if (slot.lru_prev >= 0) {
+        slots[slot.lru_prev].lru_next = slot.lru_next;
+    } else if (cache.lru_head == index) {
+        cache.lru_head = slot.lru_next;
+    }
+    if (slot.lru_next >= 0) {
+        slots[slot.lru_next].lru_prev = slot.lru_prev;
+    } else if (cache.lru_tail == index) {
+        cache.lru_tail = slot.lru_prev;
+    }
+    slot.lru_prev = -1;
+    slot.lru_next = -1;
+}
+
+static void lruPushFront(int index) {
+    auto& slots = g_context->GetSampleSlots();
+    SampleCache& cache = g_context->GetSampleCache();
+    slots[index].lru_prev = -1;
+    slots[index].lru_next = cache.lru_head;
+    if (cache.lru_head >= 0) {
+        slots[cache.lru_head].lru_prev = index;
+    } else {
+        cache.lru_tail = index;
+    }
+    cache.lru_head = index;
+}
+
+// Release the decoded sound, the slot and its handle stay valid
+static void evictSample(int index) {
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    if (slot.sound == nullptr) {
+        return;
+    }
+    slot.sound->release();
+    slot.sound = nullptr;
+    unmapFile(&slot.pcm_cache_file);
+    if (slot.isEvictable()) {
+        lruRemove(index);
+    }
+    g_context->GetSampleCache().loaded_bytes -= slot.memory_bytes;
+    slot.pcm_bytes = 0;
+    slot.memory_bytes = 0;
+}
+
+// Evict least recently played samples until the decoded size fits the budget
+// Pinned samples and samples that may still be playing are skipped, so the budget can be exceeded
+static void enforceSampleBudget() {
+    SampleCache& cache = g_context->GetSampleCache();
+    if (cache.budget_bytes == 0) {
+        return;
+    }
+
+    auto& slots = g_context->GetSampleSlots();
+    unsigned long long now = GetTickCount64();
+    int index = cache.lru_tail;
+    while (index >= 0 && cache.loaded_bytes > cache.budget_bytes) {
+        int prev = slots[index].lru_prev;
+        if (slots[index].pin_count == 0 && slots[index].busy_until_ms <= now) {
+            evictSample(index);
+        }
+        index = prev;
+    }
+}
+
+// Decode a sample (FMOD_CREATESAMPLE) from memory or from a file
+// Compressed samples (FMOD_CREATECOMPRESSEDSAMPLE) keep the encoded data and decode while playing
+// point plays the memory in place (FMOD_OPENMEMORY_POINT), it must outlive the sound
+static FMOD::Sound* createSampleSound(const void* address, int size, const char* path, bool compressed, bool point) {
+    FMOD_MODE mode = compressed ? FMOD_CREATECOMPRESSEDSAMPLE : FMOD_CREATESAMPLE;
+    FMOD::Sound* sound = nullptr;
+    FMOD_RESULT result;
+    if (path != nullptr) {
+        result = g_context->GetFmodSystem()->createSound(path, mode, nullptr, &sound);
+    } else {
+        // Create FMOD_CREATESOUNDEXINFO for memory loading
+        FMOD_CREATESOUNDEXINFO exinfo = {};
+        exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+        exinfo.length = static_cast<unsigned int>(size);
+        result = g_context->GetFmodSystem()->createSound(
+            static_cast<const char*>(address),
+            (point ? FMOD_OPENMEMORY_POINT : FMOD_OPENMEMORY) | mode,
+            &exinfo,
+            &sound
+        );
+    }
+
+    if (result != FMOD_OK) {
+        g_context->SetLastError("Failed to load sample: FMOD error " + std::to_string(result));
+        return nullptr;
+    }
+    return sound;
+}
+
+// Read a decoded sample as interleaved float PCM
+// Returns false and sets the last error on failure, true with no frames for formats it can't read
+static bool readSamplePcm(FMOD::Sound* sound, std::vector<float>* pcm, int* channels, int* rate, FMOD_SOUND_FORMAT* format) {
+    float frequency = 0.0f;
+    unsigned int pcm_bytes = 0;
+    unsigned int frames = 0;
+    sound->getFormat(nullptr, format, channels, nullptr);
+    sound->getDefaults(&frequency, nullptr);
+    sound->getLength(&pcm_bytes, FMOD_TIMEUNIT_PCMBYTES);
+    sound->getLength(&frames, FMOD_TIMEUNIT_PCM);
+    *rate = static_cast<int>(frequency);
+    pcm->clear();
+    if (*rate <= 0 || *channels <= 0 || frames == 0) {
+        return true;
+    }
+    if (*format != FMOD_SOUND_FORMAT_PCM8 && *format != FMOD_SOUND_FORMAT_PCM16 && *format != FMOD_SOUND_FORMAT_PCM24 &&
+        *format != FMOD_SOUND_FORMAT_PCM32 && *format != FMOD_SOUND_FORMAT_PCMFLOAT) {
+        return true;
+    }
+
+    void* ptr1 = nullptr;
+    void* ptr2 = nullptr;
+    unsigned int len1 = 0;
+    unsigned int len2 = 0;
+    FMOD_RESULT result = sound->lock(0, pcm_bytes, &ptr1, &ptr2, &len1, &len2);
+    if (result != FMOD_OK) {
+        g_context->SetLastError("Failed to read sample PCM: FMOD error " + std::to_string(result));
+        return false;
+    }
+
+    // A sample is locked in one piece, len1 covers the whole buffer
+    size_t bytes_per_sample = pcm_bytes / frames / static_cast<unsigned int>(*channels);
+    size_t count = len1 / bytes_per_sample / *channels * *channels;
+    pcm->resize(count);
+    const unsigned char* bytes = static_cast<const unsigned char*>(ptr1);
+    for (size_t i = 0; i < count; i++) {
+        switch (*format) {
+        case FMOD_SOUND_FORMAT_PCM8:
+            (*pcm)[i] = static_cast<float>(static_cast<signed char>(bytes[i])) * (1.0f / 128.0f);
+            break;
+        case FMOD_SOUND_FORMAT_PCM16: {
+            int16_t value;
+            memcpy(&value, bytes + i * 2, 2);
+            (*pcm)[i] = static_cast<float>(value) * (1.0f / 32768.0f);
+            break;
+        }
+        case FMOD_SOUND_FORMAT_PCM24: {
+            int32_t value = static_cast<int32_t>((static_cast<uint32_t>(bytes[i * 3]) << 8) |
+                (static_cast<uint32_t>(bytes[i * 3 + 1]) << 16) | (static_cast<uint32_t>(bytes[i * 3 + 2]) << 24));
+            (*pcm)[i] = static_cast<float>(value >> 8) * (1.0f / 8388608.0f);
+            break;
+        }
+        case FMOD_SOUND_FORMAT_PCM32: {
+            int32_t value;
+            memcpy(&value, bytes + i * 4, 4);
+            (*pcm)[i] = static_cast<float>(value) * (1.0f / 2147483648.0f);
+            break;
+        }
+        default:
+            memcpy(&(*pcm)[i], bytes + i * 4, 4);
+            break;
+        }
+    }
+    sound->unlock(ptr1, ptr2, len1, len2);
+    return true;
+}
+
+// Create a sample from interleaved float PCM, stored as 16-bit if pcm16 or as float
+static FMOD::Sound* createPcmSound(const float* pcm, size_t count, int channels, int rate, bool pcm16) {
+    std::vector<int16_t> pcm16_data;
+    const char* data = reinterpret_cast<const char*>(pcm);
+    size_t data_bytes = count * sizeof(float);
+    if (pcm16) {
+        pcm16_data.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            float value = pcm[i] * 32768.0f;
+            value = value > 32767.0f ? 32767.0f : (value < -32768.0f ? -32768.0f : value);
+            pcm16_data[i] = static_cast<int16_t>(std::lrint(value));
+        }
+        data = reinterpret_cast<const char*>(pcm16_data.data());
+        data_bytes = count * sizeof(int16_t);
+    }
+
+    FMOD_CREATESOUNDEXINFO exinfo = {};
+    exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+    exinfo.length = static_cast<unsigned int>(data_bytes);
+    exinfo.numchannels = channels;
+    exinfo.defaultfrequency = rate;
+    exinfo.format = pcm16 ? FMOD_SOUND_FORMAT_PCM16 : FMOD_SOUND_FORMAT_PCMFLOAT;
+
+    FMOD::Sound* sound = nullptr;
+    FMOD_RESULT result = g_context->GetFmodSystem()->createSound(data, FMOD_OPENMEMORY | FMOD_OPENRAW | FMOD_CREATESAMPLE, &exinfo, &sound);
+    if (result != FMOD_OK) {
+        g_context->SetLastError("Failed to create processed sample: FMOD error " + std::to_string(result));
+        return nullptr;
+    }
+    return sound;
+}
+
+// Load-time processing of a decoded sample (SampleLoadOptions::flags)
+struct SampleProcessing {
+    int resample_rate;  // 0 = keep the rate
+    bool trim;
+    bool normalize;
+    float threshold;  // Linear
+    float target_lufs;
+};
+
+// Resample, analyze, trim and normalize a decoded sample in one pass over its PCM
+// Resampling to the mixer rate means unpitched playback needs no resampling in the mixer,
+// and the normalization gain is baked into the PCM so every play path gets it for free
+// Releases sound and returns the processed one (sound itself if nothing changed), fills loudness if analyzed
+// Returns null and sets the last error on failure
+static FMOD::Sound* processSampleSound(FMOD::Sound* sound, const SampleProcessing& processing, SampleLoudness* loudness) {
+    std::vector<float> pcm;
+    int channels = 0;
+    int rate = 0;
+    FMOD_SOUND_FORMAT format = FMOD_SOUND_FORMAT_NONE;
+    if (!readSamplePcm(sound, &pcm, &channels, &rate, &format)) {
+        sound->release();
+        return nullptr;
+    }
+    if (pcm.empty()) {
+        return sound;
+    }
+
+    bool changed = false;
+    if (processing.resample_rate != 0 && processing.resample_rate != rate) {
+        std::vector<float> resampled;
+        resampleInterleaved(pcm.data(), pcm.size() / channels, channels, rate, processing.resample_rate, &resampled);
+        pcm.swap(resampled);
+        rate = processing.resample_rate;
+        changed = true;
+    }
+
+    size_t first = 0;
+    size_t count = pcm.size();
+    if (processing.trim || processing.normalize) {
+        size_t frames = pcm.size() / channels;
+        SampleAnalysis analysis;
+        analyzeSamplePcm(pcm.data(), frames, channels, rate, processing.threshold, &analysis);
+
+        float gain = 1.0f;
+        if (processing.normalize && analysis.loudness_lufs > SAMPLE_ANALYSIS_SILENT_LUFS) {
+            gain = std::pow(10.0f, (processing.target_lufs - analysis.loudness_lufs) / 20.0f);
+            // Don't push the peak over the ceiling, quiet transients stay quieter than the target instead
+            if (gain * analysis.peak > NORMALIZE_PEAK_CEILING) {
+                gain = NORMALIZE_PEAK_CEILING / analysis.peak;
+            }
+        }
+
+        unsigned int trimmed_frames = 0;
+        if (processing.trim && analysis.audible_end > analysis.audible_start) {
+            // Keep a little before and after, so attacks and tails below the threshold aren't cut hard
+            size_t margin = static_cast<size_t>(rate) * TRIM_MARGIN_MS / 1000;
+            size_t start = analysis.audible_start > margin ? analysis.audible_start - margin : 0;
+            size_t end = frames - analysis.audible_end > margin ? analysis.audible_end + margin : frames;
+            trimmed_frames = static_cast<unsigned int>(frames - (end - start));
+            first = start * channels;
+            count = (end - start) * channels;
+        }
+
+        if (gain != 1.0f) {
+            for (size_t i = first; i < first + count; i++) {
+                pcm[i] *= gain;
+            }
+        }
+        changed = changed || gain != 1.0f || trimmed_frames != 0;
+
+        loudness->analyzed = 1;
+        loudness->loudness_lufs = analysis.loudness_lufs;
+        loudness->peak = analysis.peak;
+        loudness->gain = gain;
+        loudness->trimmed_ms = static_cast<int>(static_cast<unsigned long long>(trimmed_frames) * 1000 / rate);
+    }
+    if (!changed) {
+        return sound;
+    }
+
+    // 16-bit sources stay 16-bit so the sample takes about the same memory, deeper ones become float
+    sound->release();
+    bool pcm16 = format == FMOD_SOUND_FORMAT_PCM8 || format == FMOD_SOUND_FORMAT_PCM16;
+    return createPcmSound(pcm.data() + first, count, channels, rate, pcm16);
+}
+
+// Account for the memory of a loaded sound
+static void accountSampleSound(int index) {
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    unsigned int pcm_bytes = 0;
+    unsigned int raw_bytes = 0;
+    unsigned int length_ms = 0;
+    slot.sound->getLength(&pcm_bytes, FMOD_TIMEUNIT_PCMBYTES);
+    slot.sound->getLength(&length_ms, FMOD_TIMEUNIT_MS);
+    if (slot.is_compressed) {
+        slot.sound->getLength(&raw_bytes, FMOD_TIMEUNIT_RAWBYTES);
+    }
+
+    slot.pcm_bytes = pcm_bytes;
+    slot.memory_bytes = slot.is_compressed ? raw_bytes : pcm_bytes;
+    slot.length_ms = length_ms;
+    g_context->GetSampleCache().loaded_bytes += slot.memory_bytes;
+    if (slot.isEvictable()) {
+        lruPushFront(index);
+    }
+}
+
+// Store a sound in its slot, the sound's user data points back at the slot for voice limiting
+static void setSlotSound(int index, FMOD::Sound* sound) {
+    g_context->GetSampleSlots()[index].sound = sound;
+    sound->setUserData(reinterpret_cast<void*>(static_cast<intptr_t>(index) + 1));
+}
+
+// Store a decoded sound in its slot and account for its memory
+static void attachSampleSound(int index, FMOD::Sound* sound) {
+    setSlotSound(index, sound);
+    accountSampleSound(index);
+}
+
+// Check an asynchronous load, accounting for the sound once it is ready
+static FMOD_OPENSTATE updateSampleLoad(int index) {
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    if (!slot.is_loading) {
+        return FMOD_OPENSTATE_READY;
+    }
+
+    FMOD_OPENSTATE state = FMOD_OPENSTATE_LOADING;
+    if (slot.sound->getOpenState(&state, nullptr, nullptr, nullptr) != FMOD_OK && state != FMOD_OPENSTATE_ERROR) {
+        state = FMOD_OPENSTATE_ERROR;
+    }
+    if (state == FMOD_OPENSTATE_READY) {
+        slot.is_loading = false;
+        accountSampleSound(index);
+        enforceSampleBudget();
+    }
+    return state;
+}
+
+// Reserve a slot for a new key, reusing unloaded slots first
+// Returns the handle, or -1 (sets the last error)
+static int allocateSampleSlot(const char* key) {
+    auto& slots = g_context->GetSampleSlots();
+    auto& free_slots = g_context->GetSampleCache().free_slots;
+
+    int index;
+    if (!free_slots.empty()) {
+        index = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        if (slots.size() > static_cast<size_t>(SAMPLE_HANDLE_INDEX_MASK)) {
+            g_context->SetLastError("Too many samples loaded");
+            return -1;
+        }
+        slots.push_back(SampleSlot());
+        index = static_cast<int>(slots.size() - 1);
+    }
+
+    // Bump the generation so handles to the previous sample in this slot stop resolving
+    SampleSlot& slot = slots[index];
+    unsigned int generation = (slot.generation % SAMPLE_HANDLE_GENERATION_MASK) + 1;
+    slot = SampleSlot();
+    slot.generation = generation;
+    slot.is_used = true;
+    slot.key = key;
+
+    int handle = makeSampleHandle(index, generation);
+    g_context->GetSamplesMap()[slot.key] = handle;
+    return handle;
+}
+
+// Return a slot to the free list, the key and handle are no longer valid
+static void releaseSampleSlot(int index) {
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    g_context->GetSamplesMap().erase(slot.key);
+    unsigned int generation = slot.generation;
+    slot = SampleSlot();
+    slot.generation = generation;
+    g_context->GetSampleCache().free_slots.push_back(index);
+}
+
+static bool checkNewSampleKey(const char* key) {
+    if (key == nullptr) {
+        g_context->SetLastError("Invalid parameter: key cannot be null");
+        return false;
+    }
+
+    // Check if key already exists
+    auto& samples_map = g_context->GetSamplesMap();
+    if (samples_map.find(key) != samples_map.end()) {
+        g_context->SetLastError("Sample with key '" + std::string(key) + "' already exists");
+        return false;
+    }
+    return true;
+}
+
+// Point a new key at the sound already loaded from the same content
+// Returns the new handle, 0 if there is no such sound, or -1 (sets the last error)
+static int aliasSharedSound(uint64_t content_key, int size, const char* key) {
+    SampleCache& cache = g_context->GetSampleCache();
+    auto it = cache.shared_sounds.find(content_key);
+    if (it == cache.shared_sounds.end()) {
+        return 0;
+    }
+    int owner = it->second;
+    if (g_context->GetSampleSlots()[owner].content_size != size) {
+        return 0;
+    }
+
+    int handle = allocateSampleSlot(key);
+    if (handle < 0) {
+        return -1;
+    }
+
+    // The sound's user data keeps pointing at the owner, so voice limits are shared as well
+    auto& slots = g_context->GetSampleSlots();
+    SampleSlot& slot = slots[handle & SAMPLE_HANDLE_INDEX_MASK];
+    slot.sound = slots[owner].sound;
+    slot.is_compressed = slots[owner].is_compressed;
+    slot.pcm_bytes = slots[owner].pcm_bytes;
+    slot.length_ms = slots[owner].length_ms;
+    slot.loudness = slots[owner].loudness;
+    slot.content_key = content_key;
+    slot.content_size = size;
+    slot.shared_owner = owner;
+    slots[owner].share_count++;
+    return handle;
+}
+
+// Drop a slot's reference to a shared sound, the sound is released with the last reference
+static void releaseSharedSound(int index) {
+    auto& slots = g_context->GetSampleSlots();
+    SampleCache& cache = g_context->GetSampleCache();
+    SampleSlot& slot = slots[index];
+    int owner = slot.shared_owner;
+
+    if (owner != index) {
+        slots[owner].share_count--;
+        slot.sound = nullptr;
+        return;
+    }
+    if (slot.share_count == 1) {
+        cache.shared_sounds.erase(slot.content_key);
+        evictSample(index);
+        return;
+    }
+
+    // Hand the sound, its memory and the voice settings over to another slot using it
+    int heir = -1;
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (static_cast<int>(i) != index && slots[i].is_used && slots[i].shared_owner == index) {
+            if (heir < 0) {
+                heir = static_cast<int>(i);
+            }
+            slots[i].shared_owner = heir;
+        }
+    }
+    SampleSlot& next = slots[heir];
+    next.share_count = slot.share_count - 1;
+    next.memory_bytes = slot.memory_bytes;
+    next.max_instances = slot.max_instances;
+    next.steal_policy = slot.steal_policy;
+    next.category = slot.category;
+    next.voices.swap(slot.voices);
+    next.pcm_cache_file = slot.pcm_cache_file;
+    slot.pcm_cache_file = MappedFile();
+    next.sound->setUserData(reinterpret_cast<void*>(static_cast<intptr_t>(heir) + 1));
+    cache.shared_sounds[slot.content_key] = heir;
+
+    slot.sound = nullptr;
+    slot.memory_bytes = 0;
+}
+
 int sampleLoad(const void* address, int size, const char* key) {
+    return sampleLoadEx(address, size, key, nullptr);
+}
+
+int sampleLoadEx(const void* address, int size, const char* key, const SampleLoadOptions* options) {
     if (!isBackendInitialized()) {
         return -1;
     }
 
-    std::string keyStr(key);
-    auto& samples_map = g_context->GetSamplesMap();
+    SampleLoadOptions load_options = {};
+    if (options != nullptr) {
+        load_options = *options;
+    }
+    if (load_options.mode < SAMPLE_LOAD_DECODED || load_options.mode > SAMPLE_LOAD_AUTO) {
+        g_context->SetLastError("Invalid sample load mode: " + std::to_string(load_options.mode));
+        return -1;
+    }
+    if ((load_options.flags & ~(SAMPLE_LOAD_RESAMPLE | SAMPLE_LOAD_TRIM_SILENCE | SAMPLE_LOAD_NORMALIZE)) != 0) {
+        g_context->SetLastError("Invalid sample load flags: " + std::to_string(load_options.flags));
+        return -1;
+    }
+    if (load_options.max_instances < 0 || load_options.auto_min_length_ms < 0) {
+        g_context->SetLastError("Invalid sample load options: max_instances and auto_min_length_ms must not be negative");
+        return -1;
+    }
 
-    // Check if key already exists
-    if (samples_map.find(keyStr) != samples_map.end()) {
-        g_context->SetLastError("Sample with key '" + keyStr + "' already exists");
+    if (load_options.silence_threshold_db > 0.0f || load_options.target_lufs > 0.0f) {
+        g_context->SetLastError("Invalid sample load options: silence_threshold_db and target_lufs must not be positive");
+        return -1;
+    }
+
+    if (!checkNewSampleKey(key)) {
+        return -1;
+    }
+
+    // Resampling, trimming and normalization are done once, here
+    SampleProcessing processing = {};
+    if ((load_options.flags & SAMPLE_LOAD_RESAMPLE) != 0) {
+        g_context->GetFmodSystem()->getSoftwareFormat(&processing.resample_rate, nullptr, nullptr);
+    }
+    float threshold_db = load_options.silence_threshold_db != 0.0f ? load_options.silence_threshold_db : DEFAULT_SILENCE_THRESHOLD_DB;
+    processing.trim = (load_options.flags & SAMPLE_LOAD_TRIM_SILENCE) != 0;
+    processing.normalize = (load_options.flags & SAMPLE_LOAD_NORMALIZE) != 0;
+    processing.threshold = std::pow(10.0f, threshold_db / 20.0f);
+    processing.target_lufs = load_options.target_lufs != 0.0f ? load_options.target_lufs : DEFAULT_TARGET_LUFS;
+
+    // Everything that changes the loaded sound, so sharing and the PCM cache only match identical results
+    uint32_t load_params[5] = {static_cast<uint32_t>(load_options.mode), static_cast<uint32_t>(load_options.flags),
+        static_cast<uint32_t>(processing.resample_rate), 0, 0};
+    memcpy(&load_params[3], &threshold_db, sizeof(float));
+    memcpy(&load_params[4], &processing.target_lufs, sizeof(float));
+    uint64_t params_hash = hashBytes64(load_params, sizeof(load_params));
+
+    // Same bytes loaded the same way: alias the key to the existing sound
+    // The voice options decide auto compression and become the shared voice limit, so they have to match too
+    int voice_params[2] = {load_options.max_instances, load_options.auto_min_length_ms};
+    uint64_t data_hash = 0;
+    uint64_t content_key = 0;
+    if (address != nullptr && size > 0) {
+        data_hash = hashBytes64(address, static_cast<size_t>(size));
+        content_key = data_hash ^ params_hash ^ hashBytes64(voice_params, sizeof(voice_params));
+        int shared = aliasSharedSound(content_key, size, key);
+        if (shared != 0) {
+            return shared;
+        }
+    }
+
+    // Decoded samples come from the PCM cache when a previous launch stored them
+    SampleCache& cache = g_context->GetSampleCache();
+    bool use_pcm_cache = load_options.mode == SAMPLE_LOAD_DECODED && data_hash != 0 && !cache.pcm_cache_dir.empty();
+    PcmCacheKey pcm_key = {data_hash, size, processing.resample_rate, 0, static_cast<uint32_t>(params_hash)};
+    SampleLoudness loudness = {};
+    MappedFile pcm_file;
+    FMOD::Sound* sound = nullptr;
+    if (use_pcm_cache) {
+        sound = openCachedPcm(cache.pcm_cache_dir, pcm_key, &pcm_file, &loudness);
+        if (sound != nullptr) {
+            cache.pcm_cache_hits++;
+        } else {
+            cache.pcm_cache_misses++;
+        }
+    }
+
+    // FMOD_CREATESAMPLE pre-decodes into memory, FMOD_CREATECOMPRESSEDSAMPLE keeps the encoded data
+    // Auto opens compressed first, which is cheap, to find out the length
+    bool compressed = load_options.mode != SAMPLE_LOAD_DECODED;
+    if (sound == nullptr) {
+        sound = createSampleSound(address, size, nullptr, compressed, false);
+        if (sound == nullptr) {
+            return -1;
+        }
+
+        if (load_options.mode == SAMPLE_LOAD_AUTO) {
+            int min_length_ms = load_options.auto_min_length_ms != 0 ? load_options.auto_min_length_ms : DEFAULT_AUTO_MIN_LENGTH_MS;
+            unsigned int length_ms = 0;
+            sound->getLength(&length_ms, FMOD_TIMEUNIT_MS);
+            // Every playing instance of a compressed sample decodes on its own, so only
+            // long samples that rarely overlap are worth keeping compressed (0 is unlimited, so it may overlap)
+            bool rarely_overlaps = load_options.max_instances != 0 && load_options.max_instances <= AUTO_MAX_INSTANCES;
+            if (length_ms < static_cast<unsigned int>(min_length_ms) || !rarely_overlaps) {
+                sound->release();
+                compressed = false;
+                sound = createSampleSound(address, size, nullptr, false, false);
+                if (sound == nullptr) {
+                    return -1;
+                }
+            }
+        }
+
+        // Compressed samples decode while playing, there is no PCM to process
+        if (!compressed && (processing.resample_rate != 0 || processing.trim || processing.normalize)) {
+            sound = processSampleSound(sound, processing, &loudness);
+            if (sound == nullptr) {
+                return -1;
+            }
+        }
+        if (use_pcm_cache) {
+            storeCachedPcm(cache.pcm_cache_dir, pcm_key, sound, loudness);
+        }
+    }
+
+    int handle = allocateSampleSlot(key);
+    if (handle < 0) {
+        sound->release();
+        unmapFile(&pcm_file);
+        return -1;
+    }
+
+    // No source to reload from, so this sample only counts towards the budget
+    int index = handle & SAMPLE_HANDLE_INDEX_MASK;
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    slot.is_compressed = compressed;
+    slot.pcm_cache_file = pcm_file;
+    slot.loudness = loudness;
+    if (load_options.max_instances > 0) {
+        slot.max_instances = load_options.max_instances;
+        slot.steal_policy = SAMPLE_STEAL_OLDEST;
+        slot.voices.reserve(static_cast<size_t>(load_options.max_instances));
+    }
+    attachSampleSound(index, sound);
+    if (content_key != 0) {
+        slot.content_key = content_key;
+        slot.content_size = size;
+        slot.shared_owner = index;
+        slot.share_count = 1;
+        cache.shared_sounds[content_key] = index;
+    }
+    enforceSampleBudget();
+    return handle;
+}
+
+int sampleGetLoudness(const char* key, SampleLoudness* loudness) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (loudness == nullptr) {
+        g_context->SetLastError("Invalid parameter: loudness cannot be null");
+        return -1;
+    }
+
+    int index = findSampleIndex(key);
+    if (index < 0) {
+        return -1;
+    }
+    *loudness = g_context->GetSampleSlots()[index].loudness;
+    return 0;
+}
+
+int sampleSetPcmCache(const char* directory) {
+    if (!isBackendInitialized()) {
         return -1;
     }
 
-    // Create FMOD_CREATESOUNDEXINFO for memory loading
+    // Samples already loaded from the cache keep their mappings
+    SampleCache& cache = g_context->GetSampleCache();
+    cache.pcm_cache_dir = directory != nullptr ? directory : "";
+    return 0;
+}
+
+int sampleGetPcmCacheStats(int* hits, int* misses) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    const SampleCache& cache = g_context->GetSampleCache();
+    if (hits != nullptr) {
+        *hits = cache.pcm_cache_hits;
+    }
+    if (misses != nullptr) {
+        *misses = cache.pcm_cache_misses;
+    }
+    return 0;
+}
+
+void unmapSamplePcmCache() {
+    for (SampleSlot& slot : g_context->GetSampleSlots()) {
+        unmapFile(&slot.pcm_cache_file);
+    }
+}
+
+int sampleGetMemoryReport(SampleMemoryReport* report) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (report == nullptr) {
+        g_context->SetLastError("Invalid parameter: report cannot be null");
+        return -1;
+    }
+
+    *report = SampleMemoryReport();
+    const auto& slots = g_context->GetSampleSlots();
+    for (const SampleSlot& slot : slots) {
+        if (!slot.is_used || slot.sound == nullptr || slot.is_loading) {
+            continue;
+        }
+        if (slot.shared_owner >= 0 && &slots[slot.shared_owner] != &slot) {
+            report->shared_count++;
+            report->shared_saved_bytes += static_cast<long long>(slots[slot.shared_owner].memory_bytes);
+            continue;
+        }
+        if (slot.is_compressed) {
+            report->compressed_count++;
+            report->compressed_bytes += static_cast<long long>(slot.memory_bytes);
+            report->compressed_pcm_bytes += static_cast<long long>(slot.pcm_bytes);
+        } else {
+            report->decoded_count++;
+            report->decoded_bytes += static_cast<long long>(slot.memory_bytes);
+        }
+    }
+    return 0;
+}
+
+// Start decoding a sample on one of FMOD's non-blocking threads
+// Returns the handle, or -1 (sets the last error)
+static int startSampleLoadAsync(const void* address, int size, const char* key) {
+    if (address == nullptr || size <= 0) {
+        g_context->SetLastError("Invalid parameters: address cannot be null and size must be positive");
+        return -1;
+    }
+
+    if (!checkNewSampleKey(key)) {
+        return -1;
+    }
+
+    // Leave one core for the game thread
+    int threads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > MAX_ASYNC_LOAD_THREADS) {
+        threads = MAX_ASYNC_LOAD_THREADS;
+    }
+
     FMOD_CREATESOUNDEXINFO exinfo = {};
     exinfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
     exinfo.length = static_cast<unsigned int>(size);
+    // Round robin over the threads in use, so each gets an equal share of the loads
+    exinfo.nonblockthreadid = g_nextLoadThread % threads;
+    g_nextLoadThread = (exinfo.nonblockthreadid + 1) % threads;
 
-    // Load sound with FMOD_CREATESAMPLE (pre-decode into memory)
     FMOD::Sound* sound = nullptr;
     FMOD_RESULT result = g_context->GetFmodSystem()->createSound(
         static_cast<const char*>(address),
-        FMOD_OPENMEMORY | FMOD_CREATESAMPLE,
+        FMOD_OPENMEMORY | FMOD_CREATESAMPLE | FMOD_NONBLOCKING,
         &exinfo,
         &sound
     );
-
     if (result != FMOD_OK) {
         g_context->SetLastError("Failed to load sample: FMOD error " + std::to_string(result));
         return -1;
     }
 
-    samples_map[keyStr] = sound;
-    return 0;
+    int handle = allocateSampleSlot(key);
+    if (handle < 0) {
+        sound->release();
+        return -1;
+    }
+
+    // Memory is accounted for once the load is seen ready
+    setSlotSound(handle & SAMPLE_HANDLE_INDEX_MASK, sound);
+    g_context->GetSampleSlots()[handle & SAMPLE_HANDLE_INDEX_MASK].is_loading = true;
+    return handle;
 }
 
-int sampleOneshot(const char* key, SoundAttributes* attributes) {
+int sampleLoadAsync(const void* address, int size, const char* key) {
     if (!isBackendInitialized()) {
         return -1;
     }
 
-    std::string keyStr(key);
+    return startSampleLoadAsync(address, size, key);
+}
+
+int sampleLoadBatch(const SampleLoadRequest* requests, int count, int* handles) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (requests == nullptr || count < 0) {
+        g_context->SetLastError("Invalid parameters: requests cannot be null and count must not be negative");
+        return -1;
+    }
+
+    // Keep going on failure, the last error holds the last failed request
+    int started = 0;
+    for (int i = 0; i < count; i++) {
+        int handle = startSampleLoadAsync(requests[i].address, requests[i].size, requests[i].key);
+        if (handles != nullptr) {
+            handles[i] = handle;
+        }
+        if (handle > 0) {
+            started++;
+        }
+    }
+    return started;
+}
+
+int sampleGetOpenState(const char* key) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    int index = findSampleIndex(key);
+    if (index < 0) {
+        return -1;
+    }
+    return static_cast<int>(updateSampleLoad(index));
+}
+
+int sampleGetOpenStateBatch(const int* handles, int count, int* states) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (handles == nullptr || count < 0) {
+        g_context->SetLastError("Invalid parameters: handles cannot be null and count must not be negative");
+        return -1;
+    }
+
+    // Invalid handles (including -1 from a failed sampleLoadBatch entry) count as finished
+    int loading = 0;
+    for (int i = 0; i < count; i++) {
+        int state = -1;
+        int index = handles[i] > 0 ? getSampleIndex(handles[i]) : -1;
+        if (index >= 0) {
+            state = static_cast<int>(updateSampleLoad(index));
+            if (state == FMOD_OPENSTATE_LOADING) {
+                loading++;
+            }
+        }
+        if (states != nullptr) {
+            states[i] = state;
+        }
+    }
+    return loading;
+}
+
+int sampleRegister(const void* address, int size, const char* key) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (address == nullptr || size <= 0) {
+        g_context->SetLastError("Invalid parameters: address cannot be null and size must be positive");
+        return -1;
+    }
+
+    if (!checkNewSampleKey(key)) {
+        return -1;
+    }
+
+    // Decoded on first use, the caller keeps the memory alive until the sample is unloaded
+    int handle = allocateSampleSlot(key);
+    if (handle < 0) {
+        return -1;
+    }
+    SampleSlot& slot = g_context->GetSampleSlots()[handle & SAMPLE_HANDLE_INDEX_MASK];
+    slot.source_data = address;
+    slot.source_size = size;
+    return handle;
+}
+
+int sampleRegisterFile(const char* path, const char* key) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (path == nullptr || path[0] == '\0') {
+        g_context->SetLastError("Invalid parameter: path cannot be null or empty");
+        return -1;
+    }
+
+    if (!checkNewSampleKey(key)) {
+        return -1;
+    }
+
+    int handle = allocateSampleSlot(key);
+    if (handle < 0) {
+        return -1;
+    }
+    g_context->GetSampleSlots()[handle & SAMPLE_HANDLE_INDEX_MASK].source_path = path;
+    return handle;
+}
+
+// Register a sample of a mounted bank under its key, played in place from the mapping
+static int registerBankSample(const char* key, const BankSample& sample) {
+    int handle = allocateSampleSlot(key);
+    if (handle < 0) {
+        return -1;
+    }
+    SampleSlot& slot = g_context->GetSampleSlots()[handle & SAMPLE_HANDLE_INDEX_MASK];
+    slot.source_data = sample.data;
+    slot.source_size = sample.size;
+    slot.is_compressed = sample.compressed;
+    slot.bank = sample.bank;
+    return handle;
+}
+
+int findSampleHandle(const char* key) {
     auto& samples_map = g_context->GetSamplesMap();
+    auto it = samples_map.find(key);
+    if (it != samples_map.end()) {
+        return it->second;
+    }
+
+    BankSample sample;
+    if (findBankSample(key, &sample)) {
+        return registerBankSample(key, sample);
+    }
+    g_context->SetLastError(std::string("Sample not found: ") + key);
+    return -1;
+}
+
+static int unloadSample(int index) {
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    if (slot.pin_count > 0) {
+        g_context->SetLastError("Sample is used as a looped sound by a VR object: " + std::string(slot.key.c_str()));
+        return -1;
+    }
+
+    // Releasing the sound also stops any channel still playing it,
+    // unless other keys still share it
+    if (slot.shared_owner >= 0) {
+        releaseSharedSound(index);
+    } else {
+        evictSample(index);
+    }
+    releaseSampleSlot(index);
+    return 0;
+}
+
+int sampleUnload(const char* key) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
 
-    // Find sample by key
-    auto it = samples_map.find(keyStr);
+    if (key == nullptr) {
+        g_context->SetLastError("Invalid parameter: key cannot be null");
+        return -1;
+    }
+
+    auto& samples_map = g_context->GetSamplesMap();
+    auto it = samples_map.find(key);
     if (it == samples_map.end()) {
-        g_context->SetLastError("Sample with key '" + keyStr + "' not found");
+        g_context->SetLastError(std::string("Sample not found: ") + key);
+        return -1;
+    }
+    if ((it->second & SAMPLE_HANDLE_GROUP_BIT) != 0) {
+        return removeSampleGroup(it->second);
+    }
+    return unloadSample(it->second & SAMPLE_HANDLE_INDEX_MASK);
+}
+
+int sampleUnloadHandle(int handle) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if ((handle & SAMPLE_HANDLE_GROUP_BIT) != 0) {
+        return removeSampleGroup(handle);
+    }
+
+    int index = getSampleIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+    return unloadSample(index);
+}
+
+int unloadBankSamples(int bank) {
+    auto& slots = g_context->GetSampleSlots();
+    for (const SampleSlot& slot : slots) {
+        if (slot.is_used && slot.bank == bank && slot.pin_count > 0) {
+            g_context->SetLastError("Sample is used as a looped sound by a VR object: " + std::string(slot.key.c_str()));
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].is_used && slots[i].bank == bank) {
+            unloadSample(static_cast<int>(i));
+        }
+    }
+    return 0;
+}
+
+int sampleSetMemoryBudget(int bytes) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (bytes < 0) {
+        g_context->SetLastError("Invalid memory budget: " + std::to_string(bytes));
+        return -1;
+    }
+
+    g_context->GetSampleCache().budget_bytes = static_cast<size_t>(bytes);
+    enforceSampleBudget();
+    return 0;
+}
+
+int sampleGetMemoryUsage(int* loaded_bytes, int* budget_bytes) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    const SampleCache& cache = g_context->GetSampleCache();
+    if (loaded_bytes != nullptr) {
+        *loaded_bytes = static_cast<int>(cache.loaded_bytes);
+    }
+    if (budget_bytes != nullptr) {
+        *budget_bytes = static_cast<int>(cache.budget_bytes);
+    }
+    return 0;
+}
+
+int sampleSetVoiceLimit(const char* key, int max_instances, int steal_policy) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (max_instances < 0) {
+        g_context->SetLastError("Invalid max instances: " + std::to_string(max_instances));
+        return -1;
+    }
+    if (steal_policy < SAMPLE_STEAL_OLDEST || steal_policy > SAMPLE_STEAL_REJECT) {
+        g_context->SetLastError("Invalid steal policy: " + std::to_string(steal_policy));
+        return -1;
+    }
+
+    int index = findSampleIndex(key);
+    if (index < 0) {
+        return -1;
+    }
+
+    // Keys sharing a sound share its voices, the owner holds the settings
+    SampleSlot& slot = g_context->GetSampleSlots()[ownerSlot(index)];
+    slot.max_instances = max_instances;
+    slot.steal_policy = steal_policy;
+    // Channels started before the limit was set are not counted
+    slot.voices.clear();
+    slot.voices.reserve(static_cast<size_t>(max_instances));
+    return 0;
+}
+
+int sampleSetCategory(const char* key, int category) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (category < 0 || category >= SAMPLE_CATEGORY_COUNT) {
+        g_context->SetLastError("Invalid category: " + std::to_string(category));
+        return -1;
+    }
+
+    int index = findSampleIndex(key);
+    if (index < 0) {
+        return -1;
+    }
+    g_context->GetSampleSlots()[ownerSlot(index)].category = category;
+    return 0;
+}
+
+int sampleSetCategoryPriority(int category, int priority) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (category < 0 || category >= SAMPLE_CATEGORY_COUNT) {
+        g_context->SetLastError("Invalid category: " + std::to_string(category));
+        return -1;
+    }
+    if (priority < 0 || priority > 256) {
+        g_context->SetLastError("Invalid priority: " + std::to_string(priority));
         return -1;
     }
 
-    FMOD::Sound* sound = it->second;
+    // Applies to channels started from now on
+    g_context->GetSampleCache().category_priorities[category] = priority;
+    return 0;
+}
+
+// Slot of a sound created by the sample functions, -1 for any other sound
+static int getSoundSampleIndex(FMOD::Sound* sound) {
+    void* userdata = nullptr;
+    sound->getUserData(&userdata);
+    int index = static_cast<int>(reinterpret_cast<intptr_t>(userdata)) - 1;
+    if (index < 0 || static_cast<size_t>(index) >= g_context->GetSampleSlots().size()) {
+        return -1;
+    }
+    return index;
+}
+
+bool reserveSampleVoice(FMOD::Sound* sound, float distance, FMOD::Channel** victim_channel) {
+    *victim_channel = nullptr;
+    int index = getSoundSampleIndex(sound);
+    if (index < 0) {
+        return true;
+    }
+
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    if (slot.max_instances == 0) {
+        return true;
+    }
+
+    // Drop channels that have ended, their handles no longer resolve
+    auto& voices = slot.voices;
+    for (size_t i = 0; i < voices.size();) {
+        bool playing = false;
+        if (voices[i].channel->isPlaying(&playing) != FMOD_OK || !playing) {
+            voices.erase(voices.begin() + i);
+        } else {
+            i++;
+        }
+    }
+    if (voices.size() < static_cast<size_t>(slot.max_instances)) {
+        return true;
+    }
+
+    // Pick the victim, ties go to the oldest so the result is deterministic
+    size_t victim = 0;
+    if (slot.steal_policy == SAMPLE_STEAL_QUIETEST) {
+        float quietest = 0.0f;
+        for (size_t i = 0; i < voices.size(); i++) {
+            float audibility = 0.0f;
+            voices[i].channel->getAudibility(&audibility);
+            if (i == 0 || audibility < quietest) {
+                quietest = audibility;
+                victim = i;
+            }
+        }
+    } else if (slot.steal_policy == SAMPLE_STEAL_FARTHEST) {
+        for (size_t i = 1; i < voices.size(); i++) {
+            if (voices[i].distance > voices[victim].distance) {
+                victim = i;
+            }
+        }
+        if (distance > voices[victim].distance) {
+            g_context->SetLastError("Voice limit reached for sample: " + std::string(slot.key.c_str()));
+            return false;
+        }
+    } else if (slot.steal_policy == SAMPLE_STEAL_REJECT) {
+        g_context->SetLastError("Voice limit reached for sample: " + std::string(slot.key.c_str()));
+        return false;
+    }
+
+    *victim_channel = voices[victim].channel;
+    return true;
+}
+
+void applySamplePriority(FMOD::Sound* sound, FMOD::Channel* channel) {
+    int index = getSoundSampleIndex(sound);
+    if (index >= 0) {
+        int category = g_context->GetSampleSlots()[index].category;
+        channel->setPriority(g_context->GetSampleCache().category_priorities[category]);
+    }
+}
+
+void trackSampleVoice(FMOD::Sound* sound, FMOD::Channel* channel, float distance, FMOD::Channel* victim) {
+    int index = getSoundSampleIndex(sound);
+    if (index < 0) {
+        return;
+    }
+
+    applySamplePriority(sound, channel);
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    if (victim != nullptr) {
+        victim->stop();
+        for (size_t i = 0; i < slot.voices.size(); i++) {
+            if (slot.voices[i].channel == victim) {
+                slot.voices.erase(slot.voices.begin() + i);
+                break;
+            }
+        }
+    }
+    if (slot.max_instances > 0) {
+        SampleVoice voice;
+        voice.channel = channel;
+        voice.distance = distance;
+        slot.voices.push_back(voice);
+    }
+}
+
+FMOD::Sound* resolveSample(int handle, unsigned int delay_ms) {
+    int index = getSampleIndex(handle);
+    if (index < 0) {
+        return nullptr;
+    }
+
+    SampleSlot& slot = g_context->GetSampleSlots()[index];
+    if (slot.is_loading) {
+        FMOD_OPENSTATE state = updateSampleLoad(index);
+        if (state != FMOD_OPENSTATE_READY) {
+            if (state == FMOD_OPENSTATE_ERROR) {
+                g_context->SetLastError("Failed to load sample: " + std::string(slot.key.c_str()));
+            } else {
+                g_context->SetLastError("Sample is still loading: " + std::string(slot.key.c_str()));
+            }
+            return nullptr;
+        }
+    } else if (slot.sound == nullptr) {
+        // Evicted (or registered and never played), decode it again from its source
+        FMOD::Sound* sound = createSampleSound(slot.source_data, slot.source_size,
+            slot.source_path.empty() ? nullptr : slot.source_path.c_str(), slot.is_compressed, slot.bank >= 0);
+        if (sound == nullptr) {
+            return nullptr;
+        }
+        attachSampleSound(index, sound);
+    } else if (slot.isEvictable() && g_context->GetSampleCache().lru_head != index) {
+        lruRemove(index);
+        lruPushFront(index);
+    }
+
+    // The caller is about to play it, keep it out of eviction until it has finished
+    slot.busy_until_ms = GetTickCount64() + delay_ms + static_cast<unsigned long long>(slot.length_ms) * 2 + BUSY_MARGIN_MS;
+    enforceSampleBudget();
+    return slot.sound;
+}
+
+void pinSample(int handle, int delta) {
+    auto& slots = g_context->GetSampleSlots();
+    size_t index = static_cast<size_t>(handle & SAMPLE_HANDLE_INDEX_MASK);
+    if (handle > 0 && (handle & SAMPLE_HANDLE_GROUP_BIT) == 0 && index < slots.size() && slots[index].is_used) {
+        slots[index].pin_count += delta;
+    }
+}
+
+// Play a sample on the master group with the given attributes
+// A non-zero start_clock delays the start until that master DSP clock
+static int playSample(FMOD::Sound* sound, const SoundAttributes* attributes, unsigned long long start_clock) {
     FMOD::Channel* channel = nullptr;
+    FMOD::Channel* victim = nullptr;
+
+    if (!reserveSampleVoice(sound, 0.0f, &victim)) {
+        return -1;
+    }
 
     // Play sound (paused initially to set attributes)
     FMOD_RESULT result = g_context->GetFmodSystem()->playSound(sound, nullptr, true, &channel);
@@ -66,6 +1316,7 @@ int sampleOneshot(const char* key, SoundAttributes* attributes) {
         g_context->SetLastError("Failed to play sample: FMOD error " + std::to_string(result));
         return -1;
     }
+    trackSampleVoice(sound, channel, 0.0f, victim);
 
     // Set attributes
     if (attributes) {
@@ -74,8 +1325,130 @@ int sampleOneshot(const char* key, SoundAttributes* attributes) {
         channel->setPitch(attributes->pitch);
     }
 
+    // Sample oneshots are children of the master group, so its clock is the parent clock
+    if (start_clock != 0) {
+        channel->setDelay(start_clock, 0, true);
+    }
+
     // Unpause to start playback
     channel->setPaused(false);
 
     return 0;
 }
+
+int sampleOneshot(const char* key, SoundAttributes* attributes) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    // Find sample (or sound group) by key, groups vary a copy of the attributes
+    SoundAttributes varied = attributes != nullptr ? *attributes : DEFAULT_ATTRIBUTES;
+    FMOD::Sound* sound = findPlayback(key, &varied);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playSample(sound, &varied, 0);
+}
+
+int sampleGetHandle(const char* key) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (key == nullptr) {
+        g_context->SetLastError("Invalid parameter: key cannot be null");
+        return -1;
+    }
+
+    return findSampleHandle(key);
+}
+
+int sampleOneshotHandle(int handle, SoundAttributes* attributes) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    SoundAttributes varied = attributes != nullptr ? *attributes : DEFAULT_ATTRIBUTES;
+    FMOD::Sound* sound = resolvePlayback(handle, &varied, 0);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playSample(sound, &varied, 0);
+}
+
+// Play commands against one start clock, shared by the batch and scheduled variants
+static int playOneshotCommands(const OneshotCmd* commands, int count, unsigned long long start_clock, int time_unit) {
+    if (commands == nullptr || count < 0) {
+        g_context->SetLastError("Invalid parameters: commands cannot be null and count must not be negative");
+        return -1;
+    }
+    if (time_unit != SAMPLE_TIMEUNIT_MS && time_unit != SAMPLE_TIMEUNIT_DSPCLOCK) {
+        g_context->SetLastError("Invalid time unit: " + std::to_string(time_unit));
+        return -1;
+    }
+
+    FMOD::System* system = g_context->GetFmodSystem();
+    int rate = 0;
+    system->getSoftwareFormat(&rate, nullptr, nullptr);
+
+    unsigned long long now = 0;
+    FMOD::ChannelGroup* masterGroup = nullptr;
+    FMOD_RESULT result = system->getMasterChannelGroup(&masterGroup);
+    if (result == FMOD_OK) {
+        result = masterGroup->getDSPClock(&now, nullptr);
+    }
+    if (result != FMOD_OK) {
+        g_context->SetLastError("Failed to get DSP clock: FMOD error " + std::to_string(result));
+        return -1;
+    }
+
+    if (start_clock == 0) {
+        // The mixer keeps running while the channels are created, start one block ahead
+        // so every channel is unpaused before the start clock is reached
+        unsigned int buffer_length = 0;
+        int num_buffers = 0;
+        system->getDSPBufferSize(&buffer_length, &num_buffers);
+        start_clock = now + buffer_length;
+    }
+
+    // Keep going on failure, the last error holds the last failed command
+    int started = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned long long offset = commands[i].offset;
+        if (time_unit == SAMPLE_TIMEUNIT_MS) {
+            offset = offset * static_cast<unsigned long long>(rate) / 1000;
+        }
+
+        // A far off start must not let the sample be evicted before it plays
+        unsigned long long start = start_clock + offset;
+        unsigned long long delay_ms = start > now && rate > 0 ? (start - now) * 1000 / static_cast<unsigned long long>(rate) : 0;
+        SoundAttributes varied = commands[i].attributes;
+        FMOD::Sound* sound = resolvePlayback(commands[i].sample_handle, &varied, static_cast<unsigned int>(delay_ms < 0xFFFFFFFFull ? delay_ms : 0xFFFFFFFFull));
+        if (sound == nullptr) {
+            continue;
+        }
+
+        if (playSample(sound, &varied, start) == 0) {
+            started++;
+        }
+    }
+    return started;
+}
+
+int sampleOneshotBatch(const OneshotCmd* commands, int count) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    return playOneshotCommands(commands, count, 0, SAMPLE_TIMEUNIT_MS);
+}
+
+int sampleOneshotScheduled(const OneshotCmd* commands, int count, unsigned long long start_clock, int time_unit) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    return playOneshotCommands(commands, count, start_clock, time_unit);
+}
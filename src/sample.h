@@ -2,8 +2,160 @@
 #define SAMPLE_H
 
 #include "sound_attributes.h"
+#include "fmod/fmod.hpp"
 
+// Returns the sample handle (> 0) on success, -1 on failure
 int sampleLoad(const void* address, int size, const char* key);
+
+// How sampleLoadEx keeps the sample in memory
+const int SAMPLE_LOAD_DECODED = 0;  // FMOD_CREATESAMPLE, decoded to PCM (sampleLoad)
+const int SAMPLE_LOAD_COMPRESSED = 1;  // FMOD_CREATECOMPRESSEDSAMPLE, decoded while playing
+const int SAMPLE_LOAD_AUTO = 2;  // Compressed for long samples that rarely overlap
+
+struct SampleLoadOptions {
+    int mode;  // SAMPLE_LOAD_*
+    int max_instances;  // Voice limit (steals the oldest), 0 = unlimited
+    int auto_min_length_ms;  // Shortest sample SAMPLE_LOAD_AUTO keeps compressed, 0 = 10 seconds
+    int flags;  // SAMPLE_LOAD_*
+    float silence_threshold_db;  // SAMPLE_LOAD_TRIM_SILENCE threshold in dBFS, 0 = -60
+    float target_lufs;  // SAMPLE_LOAD_NORMALIZE target loudness, 0 = -18 LUFS
+};
+
+// Load flags, decoded samples only (processed once at load time)
+const int SAMPLE_LOAD_RESAMPLE = 1;  // Convert to the mixer rate (windowed-sinc, SSE)
+const int SAMPLE_LOAD_TRIM_SILENCE = 2;  // Cut leading and trailing silence below the threshold
+const int SAMPLE_LOAD_NORMALIZE = 4;  // Bake a gain into the PCM that brings it to the target loudness
+
+// Load-time analysis of a sample (SAMPLE_LOAD_TRIM_SILENCE / SAMPLE_LOAD_NORMALIZE)
+struct SampleLoudness {
+    int analyzed;  // 0 if the sample was loaded without analysis, the rest is 0 then
+    float loudness_lufs;  // Integrated loudness (ITU-R BS.1770) before the gain, -1000 if silent
+    float peak;  // Sample peak (linear) before the gain
+    float gain;  // Gain applied to the PCM (linear)
+    int trimmed_ms;  // Silence cut from both ends
+};
+
+int sampleGetLoudness(const char* key, SampleLoudness* loudness);
+
+// options can be null for the sampleLoad behavior
+int sampleLoadEx(const void* address, int size, const char* key, const SampleLoadOptions* options);
+
+// Resident sample memory, split by decoded and compressed samples
+struct SampleMemoryReport {
+    int decoded_count;
+    long long decoded_bytes;
+    int compressed_count;
+    long long compressed_bytes;  // Encoded data kept in memory
+    long long compressed_pcm_bytes;  // What the compressed samples would take decoded
+    int shared_count;  // Keys aliased to a sound loaded from the same bytes
+    long long shared_saved_bytes;  // Memory those keys would have taken on their own
+};
+
+int sampleGetMemoryReport(SampleMemoryReport* report);
+
+// Decoded PCM cache directory (must exist), null or empty turns the cache off
+// SAMPLE_LOAD_DECODED loads look the source up there before decoding, and store the PCM after
+int sampleSetPcmCache(const char* directory);
+int sampleGetPcmCacheStats(int* hits, int* misses);
+// Unmap the cache files, after the FMOD system (and every sound reading them) is released
+void unmapSamplePcmCache();
 int sampleOneshot(const char* key, SoundAttributes* attributes);
 
+// Get the handle of a loaded sample, -1 if not loaded
+int sampleGetHandle(const char* key);
+int sampleOneshotHandle(int handle, SoundAttributes* attributes);
+
+// One entry of sampleLoadBatch
+struct SampleLoadRequest {
+    const void* address;  // Must stay valid until the load is no longer FMOD_OPENSTATE_LOADING
+    int size;
+    const char* key;
+};
+
+// Decode on FMOD's non-blocking threads, spread round-robin
+// Playing before the load is ready fails with "Sample is still loading"
+int sampleLoadAsync(const void* address, int size, const char* key);
+// handles can be null, failed entries get -1. Returns the number of loads started
+int sampleLoadBatch(const SampleLoadRequest* requests, int count, int* handles);
+// Returns the FMOD_OPENSTATE of the sample, -1 if not found
+int sampleGetOpenState(const char* key);
+// states can be null, invalid handles get -1. Returns the number still loading
+int sampleGetOpenStateBatch(const int* handles, int count, int* states);
+
+// One oneshot of sampleOneshotBatch / sampleOneshotScheduled
+struct OneshotCmd {
+    int sample_handle;
+    SoundAttributes attributes;
+    unsigned int offset;  // Start offset from the batch start, in ms or DSP clock samples
+};
+
+// Time units of OneshotCmd::offset for sampleOneshotScheduled
+const int SAMPLE_TIMEUNIT_MS = 0;
+const int SAMPLE_TIMEUNIT_DSPCLOCK = 1;
+
+// Start every command against one master DSP clock, offsets in ms
+// Returns the number of oneshots started, -1 on invalid parameters
+int sampleOneshotBatch(const OneshotCmd* commands, int count);
+// start_clock is a master DSP clock (coreGetDSPClock), 0 for the next mixer block
+int sampleOneshotScheduled(const OneshotCmd* commands, int count, unsigned long long start_clock, int time_unit);
+
+// Register a sample without decoding it, it is decoded on first use and can be evicted
+// sampleRegister does not copy, the memory must stay valid until the sample is unloaded
+int sampleRegister(const void* address, int size, const char* key);
+int sampleRegisterFile(const char* path, const char* key);
+int sampleUnload(const char* key);
+int sampleUnloadHandle(int handle);
+
+// Decoded PCM budget in bytes, 0 = unlimited
+int sampleSetMemoryBudget(int bytes);
+int sampleGetMemoryUsage(int* loaded_bytes, int* budget_bytes);
+
+// Sample handle layout: bits 0-15 slot index, bits 16-29 generation (never 0)
+// A handle stays valid until its slot is reused, then the generation no longer matches
+const int SAMPLE_HANDLE_INDEX_BITS = 16;
+const int SAMPLE_HANDLE_INDEX_MASK = (1 << SAMPLE_HANDLE_INDEX_BITS) - 1;
+const int SAMPLE_HANDLE_GENERATION_MASK = (1 << 14) - 1;
+
+// What happens when a sample is played at its instance limit
+const int SAMPLE_STEAL_OLDEST = 0;
+const int SAMPLE_STEAL_QUIETEST = 1;
+const int SAMPLE_STEAL_FARTHEST = 2;  // Rejects the new play if it is farther than every playing instance
+const int SAMPLE_STEAL_REJECT = 3;
+
+const int SAMPLE_CATEGORY_COUNT = 16;
+// FMOD channel priority, 0 is the most important and 256 the least
+const int SAMPLE_DEFAULT_PRIORITY = 128;
+
+int sampleSetVoiceLimit(const char* key, int max_instances, int steal_policy);
+int sampleSetCategory(const char* key, int category);
+int sampleSetCategoryPriority(int category, int priority);
+
+// Resolve a handle to the sound for playing it (findPlayback / resolvePlayback for keys and groups)
+// Evicted samples are decoded again, and the sample becomes the most recently used
+// delay_ms is how far in the future the play starts, the sample is kept from eviction until it has finished
+// Returns null and sets the last error if the sample is not loaded
+FMOD::Sound* resolveSample(int handle, unsigned int delay_ms);
+
+// Voice limiting, used by every oneshot path around playSound
+// reserveSampleVoice picks the voice to steal under the sample's limit (victim, null if there is room),
+// false (sets the last error) if the play is rejected
+// trackSampleVoice stops the victim now that the new channel exists, applies the category priority
+// and tracks the new channel; a failed play never gets here, so the victim keeps playing
+bool reserveSampleVoice(FMOD::Sound* sound, float distance, FMOD::Channel** victim);
+void trackSampleVoice(FMOD::Sound* sound, FMOD::Channel* channel, float distance, FMOD::Channel* victim);
+// Only the category priority, for looped channels that don't count towards the limit
+void applySamplePriority(FMOD::Sound* sound, FMOD::Channel* channel);
+
+// Sample or group handle of a key, -1 (sets the last error) if not found
+// Keys of mounted banks are registered on their first lookup
+int findSampleHandle(const char* key);
+// Unload every sample registered from a bank, fails if one of them is pinned
+int unloadBankSamples(int bank);
+
+// True for a live sample handle, doesn't set the last error
+bool isValidSampleHandle(int handle);
+
+// Add delta to the pin count, pinned samples are never evicted or unloaded
+void pinSample(int handle, int delta);
+
 #endif // SAMPLE_H
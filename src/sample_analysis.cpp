@@ -0,0 +1,187 @@
+#include "sample_analysis.h"
+#include <cmath>
+#include <vector>
+#include <emmintrin.h>
+
+static const double PI = 3.14159265358979323846;
+// BS.1770 gating block and step
+static const double BLOCK_SECONDS = 0.4;
+static const double STEP_SECONDS = 0.1;
+static const double ABSOLUTE_GATE_LUFS = -70.0;
+static const double RELATIVE_GATE_LU = -10.0;
+
+struct Biquad {
+    double b0, b1, b2, a1, a2;
+};
+
+// K-weighting for any rate: high shelf (head) then high pass (RLB), as derived in libebur128
+static void kWeightingFilters(int rate, Biquad* shelf, Biquad* highpass) {
+    double f0 = 1681.974450955533;
+    double gain_db = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(PI * f0 / rate);
+    double vh = std::pow(10.0, gain_db / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf->b0 = (vh + vb * k / q + k * k) / a0;
+    shelf->b1 = 2.0 * (k * k - vh) / a0;
+    shelf->b2 = (vh - vb * k / q + k * k) / a0;
+    shelf->a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf->a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(PI * f0 / rate);
+    a0 = 1.0 + k / q + k * k;
+    highpass->b0 = 1.0;
+    highpass->b1 = -2.0;
+    highpass->b2 = 1.0;
+    highpass->a1 = 2.0 * (k * k - 1.0) / a0;
+    highpass->a2 = (1.0 - k / q + k * k) / a0;
+}
+
+// Channel weights for the common layouts, the LFE of 5.1 / 7.1 is left out
+static double channelWeight(int channel, int channels) {
+    if (channels == 6 || channels == 8) {
+        if (channel == 3) {
+            return 0.0;
+        }
+        if (channel >= 4) {
+            return 1.41;
+        }
+    }
+    return 1.0;
+}
+
+// Largest absolute value of count floats, four at a time
+static float absoluteMax(const float* values, size_t count) {
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 max4 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        max4 = _mm_max_ps(max4, _mm_and_ps(_mm_loadu_ps(values + i), sign_mask));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, max4);
+    float result = std::fmax(std::fmax(lanes[0], lanes[1]), std::fmax(lanes[2], lanes[3]));
+    for (; i < count; i++) {
+        result = std::fmax(result, std::fabs(values[i]));
+    }
+    return result;
+}
+
+void analyzeSamplePcm(const float* pcm, size_t frames, int channels, int rate, float threshold, SampleAnalysis* analysis) {
+    analysis->audible_start = 0;
+    analysis->audible_end = 0;
+    analysis->peak = 0.0f;
+    analysis->loudness_lufs = SAMPLE_ANALYSIS_SILENT_LUFS;
+    if (frames == 0 || channels <= 0 || rate <= 0) {
+        return;
+    }
+
+    // Audible range and peak, scanned in chunks of frames from both ends
+    const size_t chunk_frames = 64;
+    size_t start = frames;
+    for (size_t f = 0; f < frames; f += chunk_frames) {
+        size_t n = frames - f < chunk_frames ? frames - f : chunk_frames;
+        if (absoluteMax(pcm + f * channels, n * channels) > threshold) {
+            for (size_t i = f; i < f + n; i++) {
+                if (absoluteMax(pcm + i * channels, static_cast<size_t>(channels)) > threshold) {
+                    start = i;
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    size_t end = start;
+    for (size_t f = frames; f > start; ) {
+        size_t n = f - start < chunk_frames ? f - start : chunk_frames;
+        f -= n;
+        if (absoluteMax(pcm + f * channels, n * channels) > threshold) {
+            for (size_t i = f + n; i > f; i--) {
+                if (absoluteMax(pcm + (i - 1) * channels, static_cast<size_t>(channels)) > threshold) {
+                    end = i;
+                    break;
+                }
+            }
+            break;
+        }
+    }
+    analysis->audible_start = start < frames ? start : 0;
+    analysis->audible_end = start < frames ? end : 0;
+    analysis->peak = absoluteMax(pcm, frames * static_cast<size_t>(channels));
+
+    // Mean square of the K-weighted signal per 100 ms step, per channel
+    Biquad shelf;
+    Biquad highpass;
+    kWeightingFilters(rate, &shelf, &highpass);
+    size_t step_frames = static_cast<size_t>(rate * STEP_SECONDS);
+    size_t steps = (frames + step_frames - 1) / step_frames;
+    std::vector<double> step_energy(steps, 0.0);
+    for (int c = 0; c < channels; c++) {
+        double weight = channelWeight(c, channels);
+        if (weight == 0.0) {
+            continue;
+        }
+        double s1 = 0.0, s2 = 0.0, h1 = 0.0, h2 = 0.0;
+        for (size_t f = 0; f < frames; f++) {
+            // Transposed direct form II, shelf then high pass
+            double x = pcm[f * channels + c];
+            double y = shelf.b0 * x + s1;
+            s1 = shelf.b1 * x - shelf.a1 * y + s2;
+            s2 = shelf.b2 * x - shelf.a2 * y;
+            double z = highpass.b0 * y + h1;
+            h1 = highpass.b1 * y - highpass.a1 * z + h2;
+            h2 = highpass.b2 * y - highpass.a2 * z;
+            step_energy[f / step_frames] += weight * z * z;
+        }
+    }
+
+    // 400 ms blocks are 4 steps; a shorter sample is one block over its whole length
+    size_t block_steps = static_cast<size_t>(BLOCK_SECONDS / STEP_SECONDS + 0.5);
+    std::vector<double> blocks;
+    if (steps < block_steps) {
+        double energy = 0.0;
+        for (double e : step_energy) {
+            energy += e;
+        }
+        blocks.push_back(energy / frames);
+    } else {
+        for (size_t b = 0; b + block_steps <= steps; b++) {
+            double energy = 0.0;
+            for (size_t s = b; s < b + block_steps; s++) {
+                energy += step_energy[s];
+            }
+            size_t block_frames = block_steps * step_frames;
+            if (b + block_steps == steps && frames % step_frames != 0) {
+                block_frames -= step_frames - frames % step_frames;
+            }
+            blocks.push_back(energy / block_frames);
+        }
+    }
+
+    // Absolute gate, then the relative gate 10 LU below the absolute-gated loudness
+    double absolute_gate = std::pow(10.0, (ABSOLUTE_GATE_LUFS + 0.691) / 10.0);
+    double sum = 0.0;
+    size_t count = 0;
+    for (double energy : blocks) {
+        if (energy > absolute_gate) {
+            sum += energy;
+            count++;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+    double relative_gate = sum / count * std::pow(10.0, RELATIVE_GATE_LU / 10.0);
+    sum = 0.0;
+    count = 0;
+    for (double energy : blocks) {
+        if (energy > absolute_gate && energy > relative_gate) {
+            sum += energy;
+            count++;
+        }
+    }
+    analysis->loudness_lufs = static_cast<float>(-0.691 + 10.0 * std::log10(sum / count));
+}
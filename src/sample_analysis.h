@@ -0,0 +1,22 @@
+#ifndef SAMPLE_ANALYSIS_H
+#define SAMPLE_ANALYSIS_H
+
+#include <cstddef>
+
+// Result of analyzeSamplePcm
+struct SampleAnalysis {
+    size_t audible_start;  // First frame of the audible range
+    size_t audible_end;  // One past its last frame, equal to audible_start if the sample is silent
+    float peak;  // Sample peak (linear) over every channel
+    float loudness_lufs;  // Integrated loudness (ITU-R BS.1770), -1000 if silent
+};
+
+// Silent samples report this loudness
+const float SAMPLE_ANALYSIS_SILENT_LUFS = -1000.0f;
+
+// One pass over interleaved float PCM: the range above threshold (linear, any channel), the peak
+// and the integrated loudness (K-weighted, 400 ms blocks with 75% overlap, absolute and relative gates)
+// Samples shorter than a block are measured as one block
+void analyzeSamplePcm(const float* pcm, size_t frames, int channels, int rate, float threshold, SampleAnalysis* analysis);
+
+#endif // SAMPLE_ANALYSIS_H
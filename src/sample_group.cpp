@@ -0,0 +1,206 @@
+#include "sample_group.h"
+#include "sample.h"
+#include "context.h"
+#include "hash.h"
+#include <cstring>
+#include <string>
+
+extern AudioBackendContext* g_context;
+
+// xorshift32, each group has its own state so selection is reproducible per group
+static uint32_t nextRandom(uint32_t& state) {
+    uint32_t x = state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    return x;
+}
+
+// Uniform value in [min, max], or 1 when the range is unset
+static float randomScale(uint32_t& state, float min, float max) {
+    if (min == 0.0f && max == 0.0f) {
+        return 1.0f;
+    }
+    float t = static_cast<float>(nextRandom(state) >> 8) * (1.0f / 16777216.0f);
+    return min + (max - min) * t;
+}
+
+// Group index of a live group handle, or -1 (sets the last error)
+static int getGroupIndex(int handle) {
+    auto& groups = g_context->GetSampleGroups();
+    size_t index = static_cast<size_t>(handle & SAMPLE_HANDLE_INDEX_MASK);
+    unsigned int generation = static_cast<unsigned int>(handle >> SAMPLE_HANDLE_INDEX_BITS) & SAMPLE_HANDLE_GENERATION_MASK;
+    if ((handle & SAMPLE_HANDLE_GROUP_BIT) == 0 || index >= groups.size() || !groups[index].is_used || groups[index].generation != generation) {
+        g_context->SetLastError("Invalid sound group handle: " + std::to_string(handle));
+        return -1;
+    }
+    return static_cast<int>(index);
+}
+
+static bool checkRange(float min, float max, const char* name) {
+    if (min < 0.0f || max < min) {
+        g_context->SetLastError(std::string("Invalid ") + name + " range: " + std::to_string(min) + " - " + std::to_string(max));
+        return false;
+    }
+    return true;
+}
+
+int sampleGroupCreate(const char* key, const int* sample_handles, int count, const SampleGroupConfig* config) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (key == nullptr || sample_handles == nullptr) {
+        g_context->SetLastError("Invalid parameters: key and sample_handles cannot be null");
+        return -1;
+    }
+    if (count <= 0 || count > SAMPLE_GROUP_MAX_MEMBERS) {
+        g_context->SetLastError("Invalid sound group size: " + std::to_string(count) + " (1 - " + std::to_string(SAMPLE_GROUP_MAX_MEMBERS) + ")");
+        return -1;
+    }
+
+    SampleGroupConfig group_config = {};
+    if (config != nullptr) {
+        group_config = *config;
+    }
+    if (!checkRange(group_config.pitch_min, group_config.pitch_max, "pitch") ||
+        !checkRange(group_config.volume_min, group_config.volume_max, "volume")) {
+        return -1;
+    }
+    if (group_config.policy < SAMPLE_GROUP_RANDOM || group_config.policy > SAMPLE_GROUP_NO_REPEAT) {
+        g_context->SetLastError("Invalid sound group policy: " + std::to_string(group_config.policy));
+        return -1;
+    }
+
+    auto& samples_map = g_context->GetSamplesMap();
+    if (samples_map.find(key) != samples_map.end()) {
+        g_context->SetLastError("Sample with key '" + std::string(key) + "' already exists");
+        return -1;
+    }
+
+    // Members must be samples, groups don't nest
+    for (int i = 0; i < count; i++) {
+        if ((sample_handles[i] & SAMPLE_HANDLE_GROUP_BIT) != 0 || !isValidSampleHandle(sample_handles[i])) {
+            g_context->SetLastError("Invalid sample handle in sound group: " + std::to_string(sample_handles[i]));
+            return -1;
+        }
+    }
+
+    auto& groups = g_context->GetSampleGroups();
+    int index = -1;
+    for (size_t i = 0; i < groups.size(); i++) {
+        if (!groups[i].is_used) {
+            index = static_cast<int>(i);
+            break;
+        }
+    }
+    if (index < 0) {
+        if (groups.size() > static_cast<size_t>(SAMPLE_HANDLE_INDEX_MASK)) {
+            g_context->SetLastError("Too many sound groups");
+            return -1;
+        }
+        groups.push_back(SampleGroup());
+        index = static_cast<int>(groups.size() - 1);
+    }
+
+    SampleGroup& group = groups[index];
+    unsigned int generation = (group.generation % SAMPLE_HANDLE_GENERATION_MASK) + 1;
+    group = SampleGroup();
+    group.generation = generation;
+    group.is_used = true;
+    group.key = key;
+    memcpy(group.members, sample_handles, sizeof(int) * count);
+    group.count = count;
+    group.pitch_min = group_config.pitch_min;
+    group.pitch_max = group_config.pitch_max;
+    group.volume_min = group_config.volume_min;
+    group.volume_max = group_config.volume_max;
+    group.policy = group_config.policy;
+    // Seed from the key, so a group plays the same sequence every run; xorshift needs a non-zero state
+    uint64_t seed = hashFnv1a(key, strlen(key));
+    group.rng = static_cast<uint32_t>(seed ^ (seed >> 32));
+    if (group.rng == 0) {
+        group.rng = 0x9e3779b9u;
+    }
+
+    int handle = SAMPLE_HANDLE_GROUP_BIT | static_cast<int>(generation << SAMPLE_HANDLE_INDEX_BITS) | index;
+    samples_map[group.key] = handle;
+    return handle;
+}
+
+int removeSampleGroup(int handle) {
+    int index = getGroupIndex(handle);
+    if (index < 0) {
+        return -1;
+    }
+
+    SampleGroup& group = g_context->GetSampleGroups()[index];
+    g_context->GetSamplesMap().erase(group.key);
+    unsigned int generation = group.generation;
+    group = SampleGroup();
+    group.generation = generation;
+    return 0;
+}
+
+FMOD::Sound* resolvePlayback(int handle, SoundAttributes* attributes, unsigned int delay_ms) {
+    if ((handle & SAMPLE_HANDLE_GROUP_BIT) == 0) {
+        return resolveSample(handle, delay_ms);
+    }
+
+    int index = getGroupIndex(handle);
+    if (index < 0) {
+        return nullptr;
+    }
+
+    SampleGroup& group = g_context->GetSampleGroups()[index];
+
+    // Members unloaded since the group was created are skipped
+    bool alive[SAMPLE_GROUP_MAX_MEMBERS];
+    int live[SAMPLE_GROUP_MAX_MEMBERS];
+    int live_count = 0;
+    for (int i = 0; i < group.count; i++) {
+        alive[i] = isValidSampleHandle(group.members[i]);
+        if (alive[i]) {
+            live[live_count++] = i;
+        }
+    }
+    if (live_count == 0) {
+        g_context->SetLastError("Sound group has no loaded members: " + std::string(group.key.c_str()));
+        return nullptr;
+    }
+
+    int pick;
+    if (live_count == 1) {
+        pick = live[0];
+    } else if (group.policy == SAMPLE_GROUP_ROUND_ROBIN) {
+        pick = (group.last + 1) % group.count;
+        while (!alive[pick]) {
+            pick = (pick + 1) % group.count;
+        }
+    } else if (group.policy == SAMPLE_GROUP_NO_REPEAT && group.last >= 0 && alive[group.last]) {
+        // Pick among the other live members, then skip over the previous one
+        int other = static_cast<int>(nextRandom(group.rng) % static_cast<uint32_t>(live_count - 1));
+        pick = live[other];
+        if (pick >= group.last) {
+            pick = live[other + 1];
+        }
+    } else {
+        pick = live[nextRandom(group.rng) % static_cast<uint32_t>(live_count)];
+    }
+    group.last = pick;
+
+    if (attributes != nullptr) {
+        attributes->pitch *= randomScale(group.rng, group.pitch_min, group.pitch_max);
+        attributes->volume *= randomScale(group.rng, group.volume_min, group.volume_max);
+    }
+    return resolveSample(group.members[pick], delay_ms);
+}
+
+FMOD::Sound* findPlayback(const char* key, SoundAttributes* attributes) {
+    int handle = findSampleHandle(key);
+    if (handle < 0) {
+        return nullptr;
+    }
+    return resolvePlayback(handle, attributes, 0);
+}
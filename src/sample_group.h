@@ -0,0 +1,40 @@
+#ifndef SAMPLE_GROUP_H
+#define SAMPLE_GROUP_H
+
+#include "sound_attributes.h"
+#include "fmod/fmod.hpp"
+
+// Sound groups share the samples_map key space and the sample handle layout,
+// with bit 30 set: bits 0-15 group index, bits 16-29 generation
+const int SAMPLE_HANDLE_GROUP_BIT = 1 << 30;
+const int SAMPLE_GROUP_MAX_MEMBERS = 16;
+
+// How a group picks the member for each play
+const int SAMPLE_GROUP_RANDOM = 0;
+const int SAMPLE_GROUP_ROUND_ROBIN = 1;
+const int SAMPLE_GROUP_NO_REPEAT = 2;  // Random, but never the previous member twice in a row
+
+// Randomization of a group, volume and pitch are multiplied by a value in [min, max]
+// A range left at 0, 0 means no randomization
+struct SampleGroupConfig {
+    float pitch_min;
+    float pitch_max;
+    float volume_min;
+    float volume_max;
+    int policy;
+};
+
+// Returns the group handle (> 0), or -1 on failure
+int sampleGroupCreate(const char* key, const int* sample_handles, int count, const SampleGroupConfig* config);
+
+// Remove a group by its handle, used by sampleUnload
+int removeSampleGroup(int handle);
+
+// Resolve a sample or group handle / key for one play
+// For a group, picks a member and scales attributes (a copy owned by the caller, can be null)
+// delay_ms is how far in the future the play starts (see resolveSample)
+// Returns null and sets the last error on failure
+FMOD::Sound* resolvePlayback(int handle, SoundAttributes* attributes, unsigned int delay_ms);
+FMOD::Sound* findPlayback(const char* key, SoundAttributes* attributes);
+
+#endif // SAMPLE_GROUP_H
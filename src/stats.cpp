@@ -0,0 +1,85 @@
+#include "stats.h"
+#include "context.h"
+#include "working_thread.h"
+#include "fmod/fmod.hpp"
+#include <atomic>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+// Latest snapshot, written by the mixer-driving thread and copied out under the lock
+static AudioStats g_stats = {};
+static SRWLOCK g_statsLock = SRWLOCK_INIT;
+static std::atomic<int> g_openStreams(0);
+
+void refreshStatsSnapshot(FMOD::System* system) {
+    AudioStats stats = {};
+
+    FMOD_CPU_USAGE usage = {};
+    if (system->getCPUUsage(&usage) == FMOD_OK) {
+        stats.cpu_dsp = usage.dsp;
+        stats.cpu_stream = usage.stream;
+        stats.cpu_geometry = usage.geometry;
+        stats.cpu_update = usage.update;
+    }
+
+    int playing = 0;
+    int real = 0;
+    if (system->getChannelsPlaying(&playing, &real) == FMOD_OK) {
+        stats.channels_real = real;
+        stats.channels_virtual = playing - real;
+    }
+
+    // Non-blocking, the numbers may be a moment stale
+    FMOD_Memory_GetStats(&stats.memory_current, &stats.memory_peak, false);
+
+    WorkerTickStats tick;
+    getWorkerTickStats(&tick);
+    stats.tick_ms = static_cast<float>(tick.last_tick_ms);
+    stats.tick_max_ms = static_cast<float>(tick.max_tick_ms);
+    stats.tick_jitter_ms = static_cast<float>(tick.avg_jitter_ms);
+    stats.tick_interval_ms = static_cast<float>(tick.interval_ms);
+    stats.tick_overruns = static_cast<unsigned int>(tick.overruns);
+
+    AcquireSRWLockExclusive(&g_statsLock);
+    stats.snapshot_count = g_stats.snapshot_count + 1;
+    g_stats = stats;
+    ReleaseSRWLockExclusive(&g_statsLock);
+}
+
+void resetStatsSnapshot() {
+    AcquireSRWLockExclusive(&g_statsLock);
+    g_stats = AudioStats();
+    ReleaseSRWLockExclusive(&g_statsLock);
+    g_openStreams.store(0);
+}
+
+void noteStreamOpened() {
+    g_openStreams.fetch_add(1);
+}
+
+void noteStreamClosed() {
+    g_openStreams.fetch_sub(1);
+}
+
+extern "C" {
+
+// Copy the latest statistics snapshot
+int coreGetStats(AudioStats* stats) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (stats == nullptr) {
+        g_context->SetLastError("Invalid parameter: stats cannot be null");
+        return -1;
+    }
+
+    AcquireSRWLockShared(&g_statsLock);
+    *stats = g_stats;
+    ReleaseSRWLockShared(&g_statsLock);
+    stats->open_streams = g_openStreams.load();
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,53 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "fmod/fmod.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Runtime statistics snapshot
+typedef struct {
+    // Mixer CPU usage in percent (System::getCPUUsage)
+    float cpu_dsp;
+    float cpu_stream;
+    float cpu_geometry;
+    float cpu_update;
+    // Channels (System::getChannelsPlaying)
+    int channels_real;
+    int channels_virtual;
+    // FMOD memory in bytes (FMOD_Memory_GetStats)
+    int memory_current;
+    int memory_peak;
+    // Streams currently open
+    int open_streams;
+    // Working thread tick timing in milliseconds
+    float tick_ms;
+    float tick_max_ms;
+    float tick_jitter_ms;
+    float tick_interval_ms;
+    unsigned int tick_overruns;
+    // Number of times the snapshot has been refreshed
+    unsigned int snapshot_count;
+} AudioStats;
+
+// Copy the latest statistics snapshot
+// Cheap enough to call every frame, it never queries FMOD
+int coreGetStats(AudioStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Refresh the snapshot, called after each update by the thread that drives the mixer
+void refreshStatsSnapshot(FMOD::System* system);
+
+// Clear the snapshot, called on initialization
+void resetStatsSnapshot();
+
+// Track streams opened and closed by the backend
+void noteStreamOpened();
+void noteStreamClosed();
+
+#endif // STATS_H
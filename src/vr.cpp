@@ -1,4 +1,6 @@
 #include "context.h"
+#include "vr.h"
+#include "vrsourcepool.h"
 #include "fmod/fmod.hpp"
 #include "fmod/fmod_errors.h"
 
@@ -9,6 +11,12 @@ extern "C" {
 
 // Initialize VR audio (Google Resonance Audio plugin)
 int vrInitialize(const char* plugin_path) {
+    return vrInitializeEx(plugin_path, nullptr);
+}
+
+// Initialize VR audio with options
+// config can be null to use the defaults
+int vrInitializeEx(const char* plugin_path, const VrInitConfig* config) {
     // Check if backend is initialized
     if (!isBackendInitialized()) {
         g_context->SetLastError("Backend is not initialized. Call audio_coreInitialize() first.");
@@ -220,6 +228,22 @@ int vrInitialize(const char* plugin_path) {
         return -1;
     }
 
+    // Pre-warm the source DSPs used by the oneshot functions
+    VrInitConfig vr_config = {};
+    if (config != nullptr) {
+        vr_config = *config;
+    }
+    if (!vrSourcePoolInitialize(system, source_plugin_handle, vr_config)) {
+        playerSourceDsp->release();
+        playerSoundsGroup->release();
+        listenerDsp->release();
+        system->unloadPlugin(plugin_handle);
+        g_context->SetVrListenerDsp(nullptr);
+        g_context->SetVrPluginHandle(0);
+        g_context->SetVrSourcePluginHandle(0);
+        return -1;
+    }
+
     g_context->SetVrPlayerSoundsGroup(playerSoundsGroup);
     g_context->SetVrPlayerSourceDsp(playerSourceDsp);
 
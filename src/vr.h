@@ -5,7 +5,16 @@
 extern "C" {
 #endif
 
+// VR initialization options for vrInitializeEx
+// A value of 0 uses the default for that field
+typedef struct {
+    int source_pool_size;      // Resonance source DSPs created up front for oneshots, default 32
+    int source_pool_grow_by;   // DSPs added when the pool runs dry, default 8, -1 to never grow
+    int source_pool_max_size;  // Upper bound on pooled DSPs, default 256
+} VrInitConfig;
+
 int vrInitialize(const char* plugin_path);
+int vrInitializeEx(const char* plugin_path, const VrInitConfig* config);
 
 #ifdef __cplusplus
 }
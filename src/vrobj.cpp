@@ -1,29 +1,30 @@
 #include "context.h"
+#include "sample.h"
+#include "sample_group.h"
+#include "vrsourcepool.h"
 #include "vrstructs.h"
 #include "sound_attributes.h"
 #include "fmod/fmod.hpp"
 #include "fmod/fmod_errors.h"
 #include "fmod/fmod_dsp.h"
+#include <cmath>
 
 // External declaration of global context
 extern AudioBackendContext* g_context;
 
-extern "C" {
-
-// Play a oneshot sound at a relative position to the listener
-int vrOneshotRelative(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow) {
-    // Check if VR is initialized
-    if (!g_context->isVrInitialized()) {
-        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
-        return -1;
-    }
+// Distance from the listener, used to pick the voice to steal
+static float distanceFromListener(float x, float y, float z) {
+    const FMOD_VECTOR& listener = g_context->GetVrListenerAttributes().pos;
+    float dx = x - listener.x;
+    float dy = y - listener.y;
+    float dz = z - listener.z;
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
 
-    // Validate inputs
-    if (sample_key == nullptr || position3d == nullptr || sound_attributes == nullptr) {
-        g_context->SetLastError("Invalid parameters: sample_key, position3d, and sound_attributes cannot be null");
-        return -1;
-    }
+extern "C" {
 
+// Play a oneshot sound at a relative position to the listener, shared by the key and handle variants
+static int playOneshotRelative(FMOD::Sound* sound, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow) {
     FMOD::System* system = g_context->GetFmodSystem();
     if (system == nullptr) {
         g_context->SetLastError("FMOD system is null");
@@ -38,14 +39,12 @@ int vrOneshotRelative(const char* sample_key, const Position3D* position3d, Soun
         return -1;
     }
 
-    // Find the sample by key
-    auto& samples = g_context->GetSamplesMap();
-    auto it = samples.find(sample_key);
-    if (it == samples.end()) {
-        g_context->SetLastError(std::string("Sample not found: ") + sample_key);
+    // The offset is the distance from the listener, whether it follows or not
+    float distance = sqrtf(position3d->width * position3d->width + position3d->height * position3d->height + position3d->depth * position3d->depth);
+    FMOD::Channel* victim = nullptr;
+    if (!reserveSampleVoice(sound, distance, &victim)) {
         return -1;
     }
-    FMOD::Sound* sound = it->second;
 
     // Create a channel for this sound (paused initially)
     FMOD::Channel* channel = nullptr;
@@ -54,6 +53,7 @@ int vrOneshotRelative(const char* sample_key, const Position3D* position3d, Soun
         g_context->SetLastError(std::string("Failed to play sound: ") + FMOD_ErrorString(result));
         return -1;
     }
+    trackSampleVoice(sound, channel, distance, victim);
 
     // Calculate world position for DSP
     FMOD_VECTOR fmod_pos;
@@ -89,40 +89,11 @@ int vrOneshotRelative(const char* sample_key, const Position3D* position3d, Soun
 
     // Note: pan is ignored for 3D sounds as per spec
 
-    // Attach Resonance Audio Source DSP to the channel
-    unsigned int source_plugin_handle = g_context->GetVrSourcePluginHandle();
-    if (source_plugin_handle != 0) {
-        FMOD::DSP* sourceDsp = nullptr;
-        result = system->createDSPByPlugin(source_plugin_handle, &sourceDsp);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to create Resonance Audio Source DSP: ") + FMOD_ErrorString(result));
-            channel->stop();
-            return -1;
-        }
-
-        result = channel->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, sourceDsp);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to add Source DSP to channel: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
-            channel->stop();
-            return -1;
-        }
-
-        // Set distance attenuation parameters (similar to AGPP implementation)
-        // Parameter [2]: Min Distance
-        result = sourceDsp->setParameterFloat(2, 0.5f);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to set min distance: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
-            channel->stop();
-            return -1;
-        }
-
-        // Parameter [3]: Max Distance
-        result = sourceDsp->setParameterFloat(3, 200.0f);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to set max distance: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
+    // Attach a pooled Resonance Audio Source DSP to the channel
+    // Distance parameters are set when the pool creates the DSP, only the position changes per shot
+    if (g_context->GetVrSourcePluginHandle() != 0) {
+        FMOD::DSP* sourceDsp = vrSourcePoolAttach(channel);
+        if (sourceDsp == nullptr) {
             channel->stop();
             return -1;
         }
@@ -142,13 +113,10 @@ int vrOneshotRelative(const char* sample_key, const Position3D* position3d, Soun
         result = sourceDsp->setParameterData(8, &dsp_3d_attrs, sizeof(dsp_3d_attrs));
         if (result != FMOD_OK) {
             g_context->SetLastError(std::string("Failed to set 3D attributes on Source DSP: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
+            // Stopping the channel returns the DSP to the pool
             channel->stop();
             return -1;
         }
-
-        // Release our reference, the channel now owns it
-        sourceDsp->release();
     }
 
     // Unpause and play
@@ -162,8 +130,8 @@ int vrOneshotRelative(const char* sample_key, const Position3D* position3d, Soun
     return 0;
 }
 
-// Play a oneshot sound at an absolute world position
-int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes) {
+// Play a oneshot sound at a relative position to the listener
+int vrOneshotRelative(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow) {
     // Check if VR is initialized
     if (!g_context->isVrInitialized()) {
         g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
@@ -176,6 +144,41 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
         return -1;
     }
 
+    // Find the sample (or sound group) by key, groups vary a copy of the attributes
+    SoundAttributes varied = *sound_attributes;
+    FMOD::Sound* sound = findPlayback(sample_key, &varied);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playOneshotRelative(sound, position3d, &varied, follow);
+}
+
+// Play a oneshot sound by sample handle at a relative position to the listener
+int vrOneshotRelativeHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow) {
+    // Check if VR is initialized
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    // Validate inputs
+    if (position3d == nullptr || sound_attributes == nullptr) {
+        g_context->SetLastError("Invalid parameters: position3d and sound_attributes cannot be null");
+        return -1;
+    }
+
+    SoundAttributes varied = *sound_attributes;
+    FMOD::Sound* sound = resolvePlayback(sample_handle, &varied, 0);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playOneshotRelative(sound, position3d, &varied, follow);
+}
+
+// Play a oneshot sound at an absolute world position, shared by the key and handle variants
+static int playOneshotAbsolute(FMOD::Sound* sound, const Position3D* position3d, SoundAttributes* sound_attributes) {
     FMOD::System* system = g_context->GetFmodSystem();
     if (system == nullptr) {
         g_context->SetLastError("FMOD system is null");
@@ -190,14 +193,11 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
         return -1;
     }
 
-    // Find the sample by key
-    auto& samples = g_context->GetSamplesMap();
-    auto it = samples.find(sample_key);
-    if (it == samples.end()) {
-        g_context->SetLastError(std::string("Sample not found: ") + sample_key);
+    float distance = distanceFromListener(position3d->width, position3d->height, position3d->depth);
+    FMOD::Channel* victim = nullptr;
+    if (!reserveSampleVoice(sound, distance, &victim)) {
         return -1;
     }
-    FMOD::Sound* sound = it->second;
 
     // Create a channel for this sound (paused initially)
     FMOD::Channel* channel = nullptr;
@@ -206,6 +206,7 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
         g_context->SetLastError(std::string("Failed to play sound: ") + FMOD_ErrorString(result));
         return -1;
     }
+    trackSampleVoice(sound, channel, distance, victim);
 
     // Set absolute world position for DSP
     FMOD_VECTOR fmod_pos;
@@ -232,40 +233,11 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
 
     // Note: pan is ignored for 3D sounds as per spec
 
-    // Attach Resonance Audio Source DSP to the channel
-    unsigned int source_plugin_handle = g_context->GetVrSourcePluginHandle();
-    if (source_plugin_handle != 0) {
-        FMOD::DSP* sourceDsp = nullptr;
-        result = system->createDSPByPlugin(source_plugin_handle, &sourceDsp);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to create Resonance Audio Source DSP: ") + FMOD_ErrorString(result));
-            channel->stop();
-            return -1;
-        }
-
-        result = channel->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, sourceDsp);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to add Source DSP to channel: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
-            channel->stop();
-            return -1;
-        }
-
-        // Set distance attenuation parameters (similar to AGPP implementation)
-        // Parameter [2]: Min Distance
-        result = sourceDsp->setParameterFloat(2, 0.5f);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to set min distance: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
-            channel->stop();
-            return -1;
-        }
-
-        // Parameter [3]: Max Distance
-        result = sourceDsp->setParameterFloat(3, 200.0f);
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to set max distance: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
+    // Attach a pooled Resonance Audio Source DSP to the channel
+    // Distance parameters are set when the pool creates the DSP, only the position changes per shot
+    if (g_context->GetVrSourcePluginHandle() != 0) {
+        FMOD::DSP* sourceDsp = vrSourcePoolAttach(channel);
+        if (sourceDsp == nullptr) {
             channel->stop();
             return -1;
         }
@@ -285,13 +257,10 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
         result = sourceDsp->setParameterData(8, &dsp_3d_attrs, sizeof(dsp_3d_attrs));
         if (result != FMOD_OK) {
             g_context->SetLastError(std::string("Failed to set 3D attributes on Source DSP: ") + FMOD_ErrorString(result));
-            sourceDsp->release();
+            // Stopping the channel returns the DSP to the pool
             channel->stop();
             return -1;
         }
-
-        // Release our reference, the channel now owns it
-        sourceDsp->release();
     }
 
     // Unpause and play
@@ -305,8 +274,8 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
     return 0;
 }
 
-// Play a oneshot sound at the player's position (for player-emitted sounds)
-int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes) {
+// Play a oneshot sound at an absolute world position
+int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, SoundAttributes* sound_attributes) {
     // Check if VR is initialized
     if (!g_context->isVrInitialized()) {
         g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
@@ -314,11 +283,46 @@ int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes) {
     }
 
     // Validate inputs
-    if (sample_key == nullptr || sound_attributes == nullptr) {
-        g_context->SetLastError("Invalid parameters: sample_key and sound_attributes cannot be null");
+    if (sample_key == nullptr || position3d == nullptr || sound_attributes == nullptr) {
+        g_context->SetLastError("Invalid parameters: sample_key, position3d, and sound_attributes cannot be null");
         return -1;
     }
 
+    // Find the sample (or sound group) by key, groups vary a copy of the attributes
+    SoundAttributes varied = *sound_attributes;
+    FMOD::Sound* sound = findPlayback(sample_key, &varied);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playOneshotAbsolute(sound, position3d, &varied);
+}
+
+// Play a oneshot sound by sample handle at an absolute world position
+int vrOneshotAbsoluteHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes) {
+    // Check if VR is initialized
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    // Validate inputs
+    if (position3d == nullptr || sound_attributes == nullptr) {
+        g_context->SetLastError("Invalid parameters: position3d and sound_attributes cannot be null");
+        return -1;
+    }
+
+    SoundAttributes varied = *sound_attributes;
+    FMOD::Sound* sound = resolvePlayback(sample_handle, &varied, 0);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playOneshotAbsolute(sound, position3d, &varied);
+}
+
+// Play a oneshot sound at the player's position, shared by the key and handle variants
+static int playOneshotPlayer(FMOD::Sound* sound, SoundAttributes* sound_attributes) {
     FMOD::System* system = g_context->GetFmodSystem();
     if (system == nullptr) {
         g_context->SetLastError("FMOD system is null");
@@ -332,14 +336,11 @@ int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes) {
         return -1;
     }
 
-    // Find the sample by key
-    auto& samples = g_context->GetSamplesMap();
-    auto it = samples.find(sample_key);
-    if (it == samples.end()) {
-        g_context->SetLastError(std::string("Sample not found: ") + sample_key);
+    // Player sounds are at the listener
+    FMOD::Channel* victim = nullptr;
+    if (!reserveSampleVoice(sound, 0.0f, &victim)) {
         return -1;
     }
-    FMOD::Sound* sound = it->second;
 
     // Create a channel for this sound (paused initially) in the player_sounds group
     FMOD::Channel* channel = nullptr;
@@ -348,6 +349,7 @@ int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes) {
         g_context->SetLastError(std::string("Failed to play sound: ") + FMOD_ErrorString(result));
         return -1;
     }
+    trackSampleVoice(sound, channel, 0.0f, victim);
 
     // Apply sound attributes
     // Set volume
@@ -382,6 +384,53 @@ int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes) {
     return 0;
 }
 
+// Play a oneshot sound at the player's position (for player-emitted sounds)
+int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes) {
+    // Check if VR is initialized
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    // Validate inputs
+    if (sample_key == nullptr || sound_attributes == nullptr) {
+        g_context->SetLastError("Invalid parameters: sample_key and sound_attributes cannot be null");
+        return -1;
+    }
+
+    // Find the sample (or sound group) by key, groups vary a copy of the attributes
+    SoundAttributes varied = *sound_attributes;
+    FMOD::Sound* sound = findPlayback(sample_key, &varied);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playOneshotPlayer(sound, &varied);
+}
+
+// Play a oneshot sound by sample handle at the player's position
+int vrOneshotPlayerHandle(int sample_handle, SoundAttributes* sound_attributes) {
+    // Check if VR is initialized
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    // Validate inputs
+    if (sound_attributes == nullptr) {
+        g_context->SetLastError("Invalid parameter: sound_attributes cannot be null");
+        return -1;
+    }
+
+    SoundAttributes varied = *sound_attributes;
+    FMOD::Sound* sound = resolvePlayback(sample_handle, &varied, 0);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playOneshotPlayer(sound, &varied);
+}
+
 // Add a new VR object with the specified key and properties
 int vrObjectAdd(const char* key, VRObjectInfo* info) {
     // Check if VR is initialized
@@ -500,21 +549,29 @@ int vrObjectAdd(const char* key, VRObjectInfo* info) {
 
         // Release our reference, the channel group now owns it
         sourceDsp->release();
+
+        // Keep the pointer so position updates don't have to look it up
+        vrobj.source_dsp = sourceDsp;
     }
 
-    // If looped_sample_key is specified, validate and store it
+    // If looped_sample_key is specified, validate it and store its handle
     if (info->looped_sample_key != nullptr && info->looped_sample_key[0] != '\0') {
         // Validate that the sample exists
-        auto& samples = g_context->GetSamplesMap();
-        auto it = samples.find(info->looped_sample_key);
-        if (it == samples.end()) {
+        int looped_handle = findSampleHandle(info->looped_sample_key);
+        if (looped_handle < 0) {
             g_context->SetLastError(std::string("Looped sample not found: ") + info->looped_sample_key);
             vrobj.channel_group->release();
             return -1;
         }
+        if ((looped_handle & SAMPLE_HANDLE_GROUP_BIT) != 0) {
+            g_context->SetLastError(std::string("Looped sample cannot be a sound group: ") + info->looped_sample_key);
+            vrobj.channel_group->release();
+            return -1;
+        }
 
-        // Store the sample key (no need to create a new sound)
-        vrobj.looped_sample_key = info->looped_sample_key;
+        // Store the sample handle (no need to create a new sound or look the key up again)
+        vrobj.looped_sample = looped_handle;
+        pinSample(vrobj.looped_sample, 1);
     }
 
     // Store the VR object in the context
@@ -547,16 +604,26 @@ int vrObjectRemove(const char* key) {
 
     VRObject& vrobj = it->second;
 
-    // Stop the looped channel if it exists
-    if (vrobj.looped_channel != nullptr) {
+    // Stop the looped channel and release the channel group on the working thread,
+    // after any position updates still queued for this object
+    if (vrobj.channel_group != nullptr) {
+        AudioCommand command;
+        command.type = AUDIO_COMMAND_RELEASE_GROUP;
+        command.group.group = vrobj.channel_group;
+        command.group.channel = vrobj.looped_channel;
+        command.group.volume = 0.0f;
+        if (!g_context->PushCommand(command)) {
+            return -1;
+        }
+        vrobj.looped_channel = nullptr;
+        vrobj.channel_group = nullptr;
+    } else if (vrobj.looped_channel != nullptr) {
         vrobj.looped_channel->stop();
         vrobj.looped_channel = nullptr;
     }
 
-    // Release the channel group
-    if (vrobj.channel_group != nullptr) {
-        vrobj.channel_group->release();
-        vrobj.channel_group = nullptr;
+    if (vrobj.looped_sample != 0) {
+        pinSample(vrobj.looped_sample, -1);
     }
 
     // Remove from map
@@ -595,20 +662,17 @@ int vrObjectStartLooping(const char* key) {
 
     VRObject& vrobj = it->second;
 
-    // Check if there's a looped sample key
-    if (vrobj.looped_sample_key.empty()) {
+    // Check if there's a looped sample
+    if (vrobj.looped_sample == 0) {
         g_context->SetLastError(std::string("VR object has no looped sound: ") + key);
         return -1;
     }
 
-    // Get the sample by key
-    auto& samples = g_context->GetSamplesMap();
-    auto sample_it = samples.find(vrobj.looped_sample_key);
-    if (sample_it == samples.end()) {
-        g_context->SetLastError(std::string("Looped sample not found: ") + vrobj.looped_sample_key);
+    // Get the sample by handle
+    FMOD::Sound* sound = resolveSample(vrobj.looped_sample, 0);
+    if (sound == nullptr) {
         return -1;
     }
-    FMOD::Sound* sound = sample_it->second;
 
     // If already playing, stop it first
     if (vrobj.looped_channel != nullptr) {
@@ -622,6 +686,7 @@ int vrObjectStartLooping(const char* key) {
         g_context->SetLastError(std::string("Failed to play looped sound: ") + FMOD_ErrorString(result));
         return -1;
     }
+    applySamplePriority(sound, vrobj.looped_channel);
 
     // Set loop mode on the channel
     result = vrobj.looped_channel->setMode(FMOD_LOOP_NORMAL);
@@ -715,20 +780,8 @@ int vrObjectResumeLooping(const char* key) {
     return 0;
 }
 
-// Play a oneshot sound from the specified object
-int vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAttributes* attributes) {
-    // Check if VR is initialized
-    if (!g_context->isVrInitialized()) {
-        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
-        return -1;
-    }
-
-    // Validate inputs
-    if (object_key == nullptr || sample_key == nullptr || attributes == nullptr) {
-        g_context->SetLastError("Invalid parameters: object_key, sample_key, and attributes cannot be null");
-        return -1;
-    }
-
+// Play a oneshot sound from the specified object, shared by the key and handle variants
+static int playObjectOneshot(const char* object_key, FMOD::Sound* sound, SoundAttributes* attributes) {
     FMOD::System* system = g_context->GetFmodSystem();
     if (system == nullptr) {
         g_context->SetLastError("FMOD system is null");
@@ -745,14 +798,11 @@ int vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAtt
 
     VRObject& vrobj = it->second;
 
-    // Find the sample by key
-    auto& samples = g_context->GetSamplesMap();
-    auto sample_it = samples.find(sample_key);
-    if (sample_it == samples.end()) {
-        g_context->SetLastError(std::string("Sample not found: ") + sample_key);
+    float distance = distanceFromListener(vrobj.center.width, vrobj.center.height, vrobj.center.depth);
+    FMOD::Channel* victim = nullptr;
+    if (!reserveSampleVoice(sound, distance, &victim)) {
         return -1;
     }
-    FMOD::Sound* sound = sample_it->second;
 
     // Play the sound in the object's channel group (paused initially)
     FMOD::Channel* channel = nullptr;
@@ -761,6 +811,7 @@ int vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAtt
         g_context->SetLastError(std::string("Failed to play sound: ") + FMOD_ErrorString(result));
         return -1;
     }
+    trackSampleVoice(sound, channel, distance, victim);
 
     // Apply sound attributes
     result = channel->setVolume(attributes->volume);
@@ -788,6 +839,53 @@ int vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAtt
     return 0;
 }
 
+// Play a oneshot sound from the specified object
+int vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAttributes* attributes) {
+    // Check if VR is initialized
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    // Validate inputs
+    if (object_key == nullptr || sample_key == nullptr || attributes == nullptr) {
+        g_context->SetLastError("Invalid parameters: object_key, sample_key, and attributes cannot be null");
+        return -1;
+    }
+
+    // Find the sample (or sound group) by key, groups vary a copy of the attributes
+    SoundAttributes varied = *attributes;
+    FMOD::Sound* sound = findPlayback(sample_key, &varied);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playObjectOneshot(object_key, sound, &varied);
+}
+
+// Play a oneshot sound by sample handle from the specified object
+int vrObjectPlayOneshotHandle(const char* object_key, int sample_handle, SoundAttributes* attributes) {
+    // Check if VR is initialized
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    // Validate inputs
+    if (object_key == nullptr || attributes == nullptr) {
+        g_context->SetLastError("Invalid parameters: object_key and attributes cannot be null");
+        return -1;
+    }
+
+    SoundAttributes varied = *attributes;
+    FMOD::Sound* sound = resolvePlayback(sample_handle, &varied, 0);
+    if (sound == nullptr) {
+        return -1;
+    }
+
+    return playObjectOneshot(object_key, sound, &varied);
+}
+
 // Change the position of a VR object
 int vrObjectChangePosition(const char* key, Position3D pos) {
     // Check if VR is initialized
@@ -802,12 +900,6 @@ int vrObjectChangePosition(const char* key, Position3D pos) {
         return -1;
     }
 
-    FMOD::System* system = g_context->GetFmodSystem();
-    if (system == nullptr) {
-        g_context->SetLastError("FMOD system is null");
-        return -1;
-    }
-
     // Find the VR object
     auto& vr_objects = g_context->GetVrObjects();
     auto it = vr_objects.find(key);
@@ -821,36 +913,15 @@ int vrObjectChangePosition(const char* key, Position3D pos) {
     // Update the stored position
     vrobj.center = pos;
 
-    // Update the 3D position on the channel group's Resonance Audio Source DSP
-    if (vrobj.channel_group != nullptr) {
-        // Get the first DSP (which should be the Resonance Audio Source)
-        FMOD::DSP* sourceDsp = nullptr;
-        FMOD_RESULT result = vrobj.channel_group->getDSP(FMOD_CHANNELCONTROL_DSP_HEAD, &sourceDsp);
-        if (result != FMOD_OK || sourceDsp == nullptr) {
-            g_context->SetLastError(std::string("Failed to get Source DSP from channel group: ") + FMOD_ErrorString(result));
-            return -1;
-        }
-
-        // Set 3D position for the channel group's DSP
-        FMOD_VECTOR fmod_pos;
-        fmod_pos.x = pos.width;
-        fmod_pos.y = pos.height;
-        fmod_pos.z = pos.depth;
-
-        FMOD_VECTOR vel = { 0.0f, 0.0f, 0.0f };
-        FMOD_DSP_PARAMETER_3DATTRIBUTES dsp_3d_attrs = {};
-        dsp_3d_attrs.relative.position = fmod_pos;
-        dsp_3d_attrs.relative.velocity = vel;
-        dsp_3d_attrs.relative.forward = { 0.0f, 0.0f, 1.0f };
-        dsp_3d_attrs.relative.up = { 0.0f, 1.0f, 0.0f };
-        dsp_3d_attrs.absolute.position = fmod_pos;
-        dsp_3d_attrs.absolute.velocity = vel;
-        dsp_3d_attrs.absolute.forward = { 0.0f, 0.0f, 1.0f };
-        dsp_3d_attrs.absolute.up = { 0.0f, 1.0f, 0.0f };
-
-        result = sourceDsp->setParameterData(8, &dsp_3d_attrs, sizeof(dsp_3d_attrs));
-        if (result != FMOD_OK) {
-            g_context->SetLastError(std::string("Failed to set 3D attributes on Source DSP: ") + FMOD_ErrorString(result));
+    // Queue the 3D position update for the channel group's Resonance Audio Source DSP
+    if (vrobj.source_dsp != nullptr) {
+        AudioCommand command;
+        command.type = AUDIO_COMMAND_SET_SOURCE_POSITION;
+        command.source.dsp = vrobj.source_dsp;
+        command.source.position.x = pos.width;
+        command.source.position.y = pos.height;
+        command.source.position.z = pos.depth;
+        if (!g_context->PushCommand(command)) {
             return -1;
         }
     }
@@ -25,6 +25,11 @@ int vrOneshotAbsolute(const char* sample_key, const Position3D* position3d, Soun
 // Play a oneshot sound at the player's position (for player-emitted sounds)
 int vrOneshotPlayer(const char* sample_key, SoundAttributes* sound_attributes);
 
+// Sample handle variants of the oneshot functions (see audio_sampleGetHandle)
+int vrOneshotRelativeHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes, bool follow);
+int vrOneshotAbsoluteHandle(int sample_handle, const Position3D* position3d, SoundAttributes* sound_attributes);
+int vrOneshotPlayerHandle(int sample_handle, SoundAttributes* sound_attributes);
+
 // VR Object management functions
 int vrObjectAdd(const char* key, VRObjectInfo* info);
 int vrObjectRemove(const char* key);
@@ -32,6 +37,7 @@ int vrObjectStartLooping(const char* key);
 int vrObjectPauseLooping(const char* key);
 int vrObjectResumeLooping(const char* key);
 int vrObjectPlayOneshot(const char* object_key, const char* sample_key, SoundAttributes* attributes);
+int vrObjectPlayOneshotHandle(const char* object_key, int sample_handle, SoundAttributes* attributes);
 int vrObjectChangePosition(const char* key, Position3D pos);
 
 #ifdef __cplusplus
@@ -45,11 +51,12 @@ int vrObjectChangePosition(const char* key, Position3D pos);
 struct VRObject {
     Position3D center;
     Size3D size;
-    std::string looped_sample_key;  // Key to the sample, empty if no loop
+    int looped_sample;  // Handle of the looped sample, 0 if no loop
     FMOD::Channel* looped_channel;
     FMOD::ChannelGroup* channel_group;
+    FMOD::DSP* source_dsp;  // Resonance Audio Source DSP on channel_group, null if not attached
 
-    VRObject() : looped_channel(nullptr), channel_group(nullptr) {
+    VRObject() : looped_sample(0), looped_channel(nullptr), channel_group(nullptr), source_dsp(nullptr) {
         center = {0.0f, 0.0f, 0.0f};
         size = {0.0f, 0.0f, 0.0f};
     }
@@ -1,7 +1,6 @@
 #include "context.h"
 #include "vrstructs.h"
 #include "fmod/fmod.hpp"
-#include "fmod/fmod_errors.h"
 #include "fmod/fmod_dsp.h"
 
 // External declaration of global context
@@ -27,20 +26,18 @@ int setPlayerPosition(float width, float depth, float height) {
     // Update the player position in context
     g_context->SetVrPlayerPosition(position);
 
-    FMOD::System* system = g_context->GetFmodSystem();
-    if (system == nullptr) {
-        g_context->SetLastError("FMOD system is null");
-        return -1;
-    }
-
-    // Update the 3D listener position (the player's ears move with the player)
+    // Queue the 3D listener position update (the player's ears move with the player)
     FMOD_VECTOR& forward = g_context->GetVrPlayerForward();
     FMOD_VECTOR& up = g_context->GetVrPlayerUp();
     FMOD_VECTOR vel = { 0.0f, 0.0f, 0.0f };
 
-    FMOD_RESULT result = system->set3DListenerAttributes(0, &position, &vel, &forward, &up);
-    if (result != FMOD_OK) {
-        g_context->SetLastError(std::string("Failed to set 3D listener position: ") + FMOD_ErrorString(result));
+    AudioCommand command;
+    command.type = AUDIO_COMMAND_SET_LISTENER_ATTRIBUTES;
+    command.listener.pos = position;
+    command.listener.vel = vel;
+    command.listener.forward = forward;
+    command.listener.up = up;
+    if (!g_context->PushCommand(command)) {
         return -1;
     }
 
@@ -84,19 +81,17 @@ int setPlayerRotation(const UnitVector3D* front, const UnitVector3D* up) {
     g_context->SetVrPlayerForward(forward);
     g_context->SetVrPlayerUp(upVector);
 
-    FMOD::System* system = g_context->GetFmodSystem();
-    if (system == nullptr) {
-        g_context->SetLastError("FMOD system is null");
-        return -1;
-    }
-
-    // Update the 3D listener orientation
+    // Queue the 3D listener orientation update
     FMOD_VECTOR& position = g_context->GetVrPlayerPosition();
     FMOD_VECTOR vel = { 0.0f, 0.0f, 0.0f };
 
-    FMOD_RESULT result = system->set3DListenerAttributes(0, &position, &vel, &forward, &upVector);
-    if (result != FMOD_OK) {
-        g_context->SetLastError(std::string("Failed to set 3D listener rotation: ") + FMOD_ErrorString(result));
+    AudioCommand command;
+    command.type = AUDIO_COMMAND_SET_LISTENER_ATTRIBUTES;
+    command.listener.pos = position;
+    command.listener.vel = vel;
+    command.listener.forward = forward;
+    command.listener.up = upVector;
+    if (!g_context->PushCommand(command)) {
         return -1;
     }
 
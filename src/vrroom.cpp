@@ -33,7 +33,7 @@ int vrRoomAdd(Position3D centerPosition, Size3D roomSize, WallMaterials* materia
     newRoom.centerPosition = centerPosition;
     newRoom.roomSize = roomSize;
 
-    // Copy material strings to std::string (automatic memory management)
+    // Copy material strings into the backend arena
     if (materials->front) newRoom.materialFront = materials->front;
     if (materials->back) newRoom.materialBack = materials->back;
     if (materials->left) newRoom.materialLeft = materials->left;
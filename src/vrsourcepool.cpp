@@ -0,0 +1,219 @@
+#include "vrsourcepool.h"
+#include "context.h"
+#include "fmod/fmod.hpp"
+#include "fmod/fmod_errors.h"
+#include <vector>
+#include <Windows.h>
+
+// External declaration of global context
+extern AudioBackendContext* g_context;
+
+static const int DEFAULT_POOL_SIZE = 32;
+static const int DEFAULT_GROW_BY = 8;
+static const int DEFAULT_MAX_SIZE = 256;
+
+// Idle DSPs are taken on the game thread and returned from the END callback,
+// which runs inside System::update on the working thread
+static SRWLOCK g_poolLock = SRWLOCK_INIT;
+static std::vector<FMOD::DSP*> g_idle;
+static int g_total = 0;
+static bool g_active = false;
+
+static FMOD::System* g_system = nullptr;
+static unsigned int g_sourcePluginHandle = 0;
+static int g_growBy = 0;
+static int g_maxSize = 0;
+
+// Create a source DSP with the distance parameters every oneshot uses
+static FMOD::DSP* createSourceDsp() {
+    FMOD::DSP* dsp = nullptr;
+    FMOD_RESULT result = g_system->createDSPByPlugin(g_sourcePluginHandle, &dsp);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to create Resonance Audio Source DSP: ") + FMOD_ErrorString(result));
+        return nullptr;
+    }
+
+    // Parameter [2]: Min Distance, [3]: Max Distance (similar to AGPP implementation)
+    result = dsp->setParameterFloat(2, 0.5f);
+    if (result == FMOD_OK) {
+        result = dsp->setParameterFloat(3, 200.0f);
+    }
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to set distance on Source DSP: ") + FMOD_ErrorString(result));
+        dsp->release();
+        return nullptr;
+    }
+    return dsp;
+}
+
+// Return the channel's DSP to the pool when the channel ends
+static FMOD_RESULT F_CALL sourceChannelCallback(FMOD_CHANNELCONTROL* channelcontrol, FMOD_CHANNELCONTROL_TYPE controltype, FMOD_CHANNELCONTROL_CALLBACK_TYPE callbacktype, void*, void*) {
+    if (controltype != FMOD_CHANNELCONTROL_CHANNEL || callbacktype != FMOD_CHANNELCONTROL_CALLBACK_END) {
+        return FMOD_OK;
+    }
+
+    FMOD::Channel* channel = reinterpret_cast<FMOD::Channel*>(channelcontrol);
+    void* userdata = nullptr;
+    channel->getUserData(&userdata);
+    FMOD::DSP* dsp = static_cast<FMOD::DSP*>(userdata);
+    if (dsp == nullptr) {
+        return FMOD_OK;
+    }
+    channel->setUserData(nullptr);
+    channel->removeDSP(dsp);
+    // Clear the previous sound's state so it doesn't leak into the next shot
+    dsp->reset();
+
+    AcquireSRWLockExclusive(&g_poolLock);
+    if (g_active) {
+        // Capacity is reserved for every DSP, so this never allocates
+        g_idle.push_back(dsp);
+    }
+    ReleaseSRWLockExclusive(&g_poolLock);
+    return FMOD_OK;
+}
+
+bool vrSourcePoolInitialize(FMOD::System* system, unsigned int source_plugin_handle, const VrInitConfig& config) {
+    int pool_size = config.source_pool_size != 0 ? config.source_pool_size : DEFAULT_POOL_SIZE;
+    int grow_by = config.source_pool_grow_by != 0 ? config.source_pool_grow_by : DEFAULT_GROW_BY;
+    int max_size = config.source_pool_max_size != 0 ? config.source_pool_max_size : DEFAULT_MAX_SIZE;
+    if (grow_by < 0) {
+        grow_by = 0;
+    }
+    if (pool_size < 0 || max_size < 0 || pool_size > max_size) {
+        g_context->SetLastError("Invalid source pool size: " + std::to_string(pool_size) + " (max " + std::to_string(max_size) + ")");
+        return false;
+    }
+
+    g_system = system;
+    g_sourcePluginHandle = source_plugin_handle;
+    g_growBy = grow_by;
+    g_maxSize = max_size;
+
+    std::vector<FMOD::DSP*> created;
+    created.reserve(static_cast<size_t>(pool_size));
+    for (int i = 0; i < pool_size; i++) {
+        FMOD::DSP* dsp = createSourceDsp();
+        if (dsp == nullptr) {
+            for (FMOD::DSP* d : created) {
+                d->release();
+            }
+            return false;
+        }
+        created.push_back(dsp);
+    }
+
+    AcquireSRWLockExclusive(&g_poolLock);
+    g_idle.reserve(static_cast<size_t>(max_size));
+    g_idle.assign(created.begin(), created.end());
+    g_total = pool_size;
+    g_active = true;
+    ReleaseSRWLockExclusive(&g_poolLock);
+    return true;
+}
+
+void vrSourcePoolShutdown() {
+    AcquireSRWLockExclusive(&g_poolLock);
+    std::vector<FMOD::DSP*> idle;
+    idle.swap(g_idle);
+    g_total = 0;
+    g_active = false;
+    ReleaseSRWLockExclusive(&g_poolLock);
+
+    for (FMOD::DSP* dsp : idle) {
+        dsp->release();
+    }
+    g_system = nullptr;
+    g_sourcePluginHandle = 0;
+}
+
+FMOD::DSP* vrSourcePoolAttach(FMOD::Channel* channel) {
+    FMOD::DSP* dsp = nullptr;
+    int grow = 0;
+
+    AcquireSRWLockExclusive(&g_poolLock);
+    if (!g_idle.empty()) {
+        dsp = g_idle.back();
+        g_idle.pop_back();
+    } else {
+        grow = g_maxSize - g_total;
+        if (grow > g_growBy) {
+            grow = g_growBy;
+        }
+        // Count the new DSPs now so a concurrent grow can't go over the limit
+        if (grow > 0) {
+            g_total += grow;
+        }
+    }
+    ReleaseSRWLockExclusive(&g_poolLock);
+
+    if (dsp == nullptr) {
+        if (grow <= 0) {
+            g_context->SetLastError("Resonance Audio Source DSP pool is exhausted");
+            return nullptr;
+        }
+
+        // Grow outside the lock so the END callback is never held up by plugin creation
+        std::vector<FMOD::DSP*> created;
+        for (int i = 0; i < grow; i++) {
+            FMOD::DSP* created_dsp = createSourceDsp();
+            if (created_dsp == nullptr) {
+                break;
+            }
+            created.push_back(created_dsp);
+        }
+
+        AcquireSRWLockExclusive(&g_poolLock);
+        g_total -= grow - static_cast<int>(created.size());
+        if (!created.empty()) {
+            dsp = created.back();
+            created.pop_back();
+            g_idle.insert(g_idle.end(), created.begin(), created.end());
+        }
+        ReleaseSRWLockExclusive(&g_poolLock);
+
+        if (dsp == nullptr) {
+            return nullptr;
+        }
+    }
+
+    FMOD_RESULT result = channel->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp);
+    if (result != FMOD_OK) {
+        g_context->SetLastError(std::string("Failed to add Source DSP to channel: ") + FMOD_ErrorString(result));
+        AcquireSRWLockExclusive(&g_poolLock);
+        g_idle.push_back(dsp);
+        ReleaseSRWLockExclusive(&g_poolLock);
+        return nullptr;
+    }
+
+    // From here on the END callback owns returning the DSP
+    channel->setUserData(dsp);
+    channel->setCallback(sourceChannelCallback);
+    return dsp;
+}
+
+extern "C" {
+
+// Get the number of pooled source DSPs, in use and total
+int vrGetSourcePoolStats(int* in_use, int* total) {
+    if (!isBackendInitialized()) {
+        return -1;
+    }
+
+    if (!g_context->isVrInitialized()) {
+        g_context->SetLastError("VR audio is not initialized. Call audio_vrInitialize() first.");
+        return -1;
+    }
+
+    AcquireSRWLockShared(&g_poolLock);
+    if (in_use != nullptr) {
+        *in_use = g_total - static_cast<int>(g_idle.size());
+    }
+    if (total != nullptr) {
+        *total = g_total;
+    }
+    ReleaseSRWLockShared(&g_poolLock);
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,30 @@
+#ifndef VRSOURCEPOOL_H
+#define VRSOURCEPOOL_H
+
+#include "vr.h"
+#include "fmod/fmod.hpp"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Get the number of pooled source DSPs, in use and total
+int vrGetSourcePoolStats(int* in_use, int* total);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Create the pre-warmed source DSPs
+// Returns false and sets the last error on failure
+bool vrSourcePoolInitialize(FMOD::System* system, unsigned int source_plugin_handle, const VrInitConfig& config);
+
+// Release the idle DSPs; DSPs still on channels are freed with the system
+void vrSourcePoolShutdown();
+
+// Take a source DSP from the pool and attach it to the head of the channel
+// The DSP returns to the pool when the channel ends (including channel->stop())
+// Returns null and sets the last error if the pool is exhausted
+FMOD::DSP* vrSourcePoolAttach(FMOD::Channel* channel);
+
+#endif // VRSOURCEPOOL_H
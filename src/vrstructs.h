@@ -2,7 +2,7 @@
 #define VRSTRUCTS_H
 
 #include "fmod/fmod.hpp"
-#include <string>
+#include "memory_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,13 +57,13 @@ struct StoredRoom {
     Position3D centerPosition;
     Size3D roomSize;
 
-    // Wall materials as std::string for automatic memory management
-    std::string materialFront;
-    std::string materialBack;
-    std::string materialLeft;
-    std::string materialRight;
-    std::string materialFloor;
-    std::string materialCeiling;
+    // Wall materials copied into the backend arena
+    PoolString materialFront;
+    PoolString materialBack;
+    PoolString materialLeft;
+    PoolString materialRight;
+    PoolString materialFloor;
+    PoolString materialCeiling;
 };
 
 #endif
@@ -1,6 +1,9 @@
 #include "working_thread.h"
 #include "context.h"
+#include "stats.h"
+#include "bgm_playlist.h"
 #include "fmod/fmod.hpp"
+#include <atomic>
 
 extern AudioBackendContext* g_context;
 
@@ -8,24 +11,170 @@ extern AudioBackendContext* g_context;
 static HANDLE g_workerThread = NULL;
 // Event to signal thread to stop
 static HANDLE g_stopEvent = NULL;
+// Event to wake the thread early when commands are queued (auto reset)
+static HANDLE g_wakeEvent = NULL;
+// Waitable timer for the aligned tick deadline
+static HANDLE g_tickTimer = NULL;
+// Set while a wake is already signaled, so producers only call SetEvent once per tick
+static std::atomic<bool> g_wakePending(false);
+
+// Tick statistics, written by the worker and copied out under the lock
+static WorkerTickStats g_tickStats = {};
+static SRWLOCK g_tickStatsLock = SRWLOCK_INIT;
+
+// Fallback when the mixer format cannot be queried
+static const double DEFAULT_PERIOD_MS = 30.0;
+// Upper bound for the backed-off interval while nothing is playing
+static const double MAX_IDLE_INTERVAL_MS = 120.0;
+// Minimum gap between two command-triggered ticks
+static const double MIN_EARLY_GAP_MS = 2.0;
+
+static double elapsedMs(const LARGE_INTEGER& from, const LARGE_INTEGER& to, const LARGE_INTEGER& frequency) {
+    return static_cast<double>(to.QuadPart - from.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+// Arm the tick timer to fire after the given number of milliseconds
+static void armTickTimer(double ms) {
+    if (ms < 0.0) {
+        ms = 0.0;
+    }
+    // Negative due time means relative, in 100ns units
+    LARGE_INTEGER due;
+    due.QuadPart = -static_cast<LONGLONG>(ms * 10000.0);
+    SetWaitableTimer(g_tickTimer, &due, 0, NULL, NULL, FALSE);
+}
+
+// Length of one mixer block in milliseconds
+static double getMixerPeriodMs(FMOD::System* system) {
+    unsigned int buffer_length = 0;
+    int num_buffers = 0;
+    int rate = 0;
+    if (system->getDSPBufferSize(&buffer_length, &num_buffers) != FMOD_OK ||
+        system->getSoftwareFormat(&rate, nullptr, nullptr) != FMOD_OK ||
+        buffer_length == 0 || rate <= 0) {
+        return DEFAULT_PERIOD_MS;
+    }
+    return static_cast<double>(buffer_length) * 1000.0 / static_cast<double>(rate);
+}
 
 // Worker thread function
 static DWORD WINAPI workerThreadProc(LPVOID lpParam) {
-    const DWORD UPDATE_INTERVAL_MS = 30;
-
     FMOD::System* system = g_context->GetFmodSystem();
+    CommandQueue& queue = g_context->GetCommandQueue();
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    const double period_ms = getMixerPeriodMs(system);
+    double interval_ms = period_ms;
+
+    LARGE_INTEGER last_tick;
+    QueryPerformanceCounter(&last_tick);
+    // Deadline of the next timed tick, in ms relative to last_tick
+    double deadline_ms = interval_ms;
+    armTickTimer(deadline_ms);
+
+    AcquireSRWLockExclusive(&g_tickStatsLock);
+    g_tickStats.period_ms = period_ms;
+    g_tickStats.interval_ms = interval_ms;
+    ReleaseSRWLockExclusive(&g_tickStatsLock);
 
     while (true) {
-        // Wait for stop event or timeout (30ms)
-        DWORD waitResult = WaitForSingleObject(g_stopEvent, UPDATE_INTERVAL_MS);
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+
+        // Ignore wake requests right after a tick so a burst of API calls
+        // doesn't turn into a burst of updates
+        bool accept_wake = elapsedMs(last_tick, now, frequency) >= MIN_EARLY_GAP_MS;
+        HANDLE handles[3] = { g_stopEvent, g_tickTimer, g_wakeEvent };
+        DWORD waitResult;
+        if (accept_wake) {
+            waitResult = WaitForMultipleObjects(3, handles, FALSE, INFINITE);
+        } else {
+            DWORD gap = static_cast<DWORD>(MIN_EARLY_GAP_MS - elapsedMs(last_tick, now, frequency)) + 1;
+            waitResult = WaitForMultipleObjects(2, handles, FALSE, gap);
+        }
 
-        if (waitResult == WAIT_OBJECT_0) {
+        if (waitResult == WAIT_OBJECT_0 || waitResult == WAIT_FAILED) {
             // Stop event signaled, exit thread
             break;
         }
 
-        // Timeout occurred, perform FMOD update
+        bool timed = (waitResult == WAIT_OBJECT_0 + 1);
+        bool early = (waitResult == WAIT_OBJECT_0 + 2);
+        if (!timed && !early) {
+            // Gap timeout elapsed, go back to waiting with wake requests enabled
+            continue;
+        }
+
+        LARGE_INTEGER tick_start;
+        QueryPerformanceCounter(&tick_start);
+        double since_last = elapsedMs(last_tick, tick_start, frequency);
+        double jitter = timed ? since_last - deadline_ms : 0.0;
+
+        // Apply queued API commands in one batch and perform FMOD update
+        g_wakePending.store(false, std::memory_order_release);
+        int applied = drainCommandQueue(queue, system);
         system->update();
+        updateBgmPlaylists(system);
+
+        LARGE_INTEGER tick_end;
+        QueryPerformanceCounter(&tick_end);
+        double tick_ms = elapsedMs(tick_start, tick_end, frequency);
+
+        // Back off while nothing is playing and nothing was queued
+        int playing = 0;
+        system->getChannelsPlaying(&playing, nullptr);
+        bool idle = (playing == 0 && applied == 0);
+        if (idle) {
+            interval_ms = interval_ms * 2.0;
+            if (interval_ms > MAX_IDLE_INTERVAL_MS) {
+                interval_ms = MAX_IDLE_INTERVAL_MS;
+            }
+        } else {
+            interval_ms = period_ms;
+        }
+
+        bool overrun = (jitter > period_ms || tick_ms > period_ms);
+
+        // Keep ticks on the mixer grid: the next deadline follows the previous one
+        // unless we fell behind or backed off, in which case resync from now
+        double next_deadline;
+        if (timed && !overrun && !idle) {
+            next_deadline = deadline_ms + interval_ms - since_last;
+        } else if (early) {
+            next_deadline = deadline_ms - since_last;
+            if (idle || next_deadline > interval_ms) {
+                next_deadline = interval_ms;
+            }
+        } else {
+            next_deadline = interval_ms;
+        }
+        if (next_deadline < 0.0) {
+            next_deadline = 0.0;
+        }
+        last_tick = tick_start;
+        deadline_ms = next_deadline;
+        armTickTimer(deadline_ms - elapsedMs(tick_start, tick_end, frequency));
+
+        AcquireSRWLockExclusive(&g_tickStatsLock);
+        g_tickStats.ticks++;
+        if (early) g_tickStats.early_wakeups++;
+        if (idle) g_tickStats.idle_ticks++;
+        if (overrun) g_tickStats.overruns++;
+        g_tickStats.interval_ms = interval_ms;
+        if (timed) {
+            g_tickStats.last_jitter_ms = jitter;
+            if (jitter > g_tickStats.max_jitter_ms) g_tickStats.max_jitter_ms = jitter;
+            double abs_jitter = jitter < 0.0 ? -jitter : jitter;
+            g_tickStats.avg_jitter_ms += (abs_jitter - g_tickStats.avg_jitter_ms) * 0.05;
+        }
+        g_tickStats.last_tick_ms = tick_ms;
+        if (tick_ms > g_tickStats.max_tick_ms) g_tickStats.max_tick_ms = tick_ms;
+        ReleaseSRWLockExclusive(&g_tickStatsLock);
+
+        // Publish a fresh statistics snapshot for audio_coreGetStats
+        refreshStatsSnapshot(system);
     }
 
     return 0;
@@ -38,10 +187,41 @@ bool startWorkingThread() {
         return false;
     }
 
+    // Create wake event (auto reset, initially non-signaled)
+    g_wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (g_wakeEvent == NULL) {
+        CloseHandle(g_stopEvent);
+        g_stopEvent = NULL;
+        return false;
+    }
+
+    // Prefer a high resolution timer, the default timer granularity (~15.6ms)
+    // is coarser than a typical mixer block
+    g_tickTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (g_tickTimer == NULL) {
+        g_tickTimer = CreateWaitableTimer(NULL, FALSE, NULL);
+    }
+    if (g_tickTimer == NULL) {
+        CloseHandle(g_wakeEvent);
+        CloseHandle(g_stopEvent);
+        g_wakeEvent = NULL;
+        g_stopEvent = NULL;
+        return false;
+    }
+
+    AcquireSRWLockExclusive(&g_tickStatsLock);
+    g_tickStats = WorkerTickStats();
+    ReleaseSRWLockExclusive(&g_tickStatsLock);
+    g_wakePending.store(false);
+
     // Create worker thread
     g_workerThread = CreateThread(NULL, 0, workerThreadProc, NULL, 0, NULL);
     if (g_workerThread == NULL) {
+        CloseHandle(g_tickTimer);
+        CloseHandle(g_wakeEvent);
         CloseHandle(g_stopEvent);
+        g_tickTimer = NULL;
+        g_wakeEvent = NULL;
         g_stopEvent = NULL;
         return false;
     }
@@ -62,7 +242,26 @@ void stopWorkingThread() {
 
     // Cleanup handles
     CloseHandle(g_workerThread);
+    CloseHandle(g_tickTimer);
+    CloseHandle(g_wakeEvent);
     CloseHandle(g_stopEvent);
     g_workerThread = NULL;
+    g_tickTimer = NULL;
+    g_wakeEvent = NULL;
     g_stopEvent = NULL;
 }
+
+void wakeWorkingThread() {
+    if (g_wakeEvent == NULL) {
+        return;
+    }
+    if (!g_wakePending.exchange(true, std::memory_order_acq_rel)) {
+        SetEvent(g_wakeEvent);
+    }
+}
+
+void getWorkerTickStats(WorkerTickStats* stats) {
+    AcquireSRWLockShared(&g_tickStatsLock);
+    *stats = g_tickStats;
+    ReleaseSRWLockShared(&g_tickStatsLock);
+}
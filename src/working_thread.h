@@ -3,6 +3,21 @@
 
 #include <Windows.h>
 
+// Timing statistics of the working thread's update ticks
+struct WorkerTickStats {
+    unsigned long long ticks;          // Total number of update ticks
+    unsigned long long early_wakeups;  // Ticks started early because commands were queued
+    unsigned long long idle_ticks;     // Ticks run with a backed-off interval
+    unsigned long long overruns;       // Ticks that started or finished more than one period late
+    double period_ms;                  // Mixer block period the ticks are aligned to
+    double interval_ms;                // Current interval (period_ms, or longer while idle)
+    double last_jitter_ms;             // Lateness of the last timed tick against its deadline
+    double max_jitter_ms;
+    double avg_jitter_ms;              // Exponential moving average
+    double last_tick_ms;               // Time spent applying commands and calling update()
+    double max_tick_ms;
+};
+
 // Start the working thread
 // Returns true on success, false on failure
 bool startWorkingThread();
@@ -10,4 +25,11 @@ bool startWorkingThread();
 // Stop the working thread and wait for it to finish
 void stopWorkingThread();
 
+// Wake the working thread early so queued commands are applied without
+// waiting for the next tick. Cheap to call repeatedly.
+void wakeWorkingThread();
+
+// Copy the current tick statistics
+void getWorkerTickStats(WorkerTickStats* stats);
+
 #endif // WORKING_THREAD_H
@@ -0,0 +1,86 @@
+// Offline packer for sample bank files mounted with audio_bankMount
+//
+// Usage: bankpack <output.bank> <file> [<file> ...]
+//        a file can be given as key=path, otherwise the key is the file name without the extension
+//        the first '=' ends the key, so keys can't contain '=' and a path containing '=' needs a key
+//
+// Builds from the same bank_format.cpp as audiobackend.dll, so the layouts always match
+
+#include "bank_format.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Key from a path: file name without directories and extension
+static std::string keyFromPath(const std::string& path) {
+    size_t start = path.find_last_of("/\\");
+    start = start == std::string::npos ? 0 : start + 1;
+    size_t end = path.find_last_of('.');
+    if (end == std::string::npos || end < start) {
+        end = path.size();
+    }
+    return path.substr(start, end - start);
+}
+
+static bool readFile(const std::string& path, std::vector<char>* data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    data->resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(file.read(data->data(), size));
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: bankpack <output.bank> <[key=]file> [<[key=]file> ...]\n";
+        return 1;
+    }
+
+    std::vector<BankInput> inputs;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        BankInput input;
+        std::string path = arg;
+        size_t equals = arg.find('=');
+        if (equals != std::string::npos) {
+            input.key = arg.substr(0, equals);
+            path = arg.substr(equals + 1);
+            // A separator before the '=' means it was part of a path given without a key
+            if (input.key.empty() || input.key.find_first_of("/\\") != std::string::npos) {
+                std::cerr << "Invalid key: " << arg << " (keys can't contain '=', give a path containing '=' as key=path)\n";
+                return 1;
+            }
+        } else {
+            input.key = keyFromPath(arg);
+        }
+        if (!readFile(path, &input.data)) {
+            std::cerr << "Failed to read file: " << path << "\n";
+            return 1;
+        }
+        inputs.push_back(input);
+    }
+
+    std::vector<char> bank;
+    std::string error;
+    if (!buildBank(inputs, &bank, &error)) {
+        std::cerr << "Failed to build bank: " << error << "\n";
+        return 1;
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    if (!out.is_open() || !out.write(bank.data(), static_cast<std::streamsize>(bank.size()))) {
+        std::cerr << "Failed to write bank: " << argv[1] << "\n";
+        return 1;
+    }
+
+    for (const BankInput& input : inputs) {
+        std::cout << input.key << ": " << input.data.size() << " bytes"
+                  << (isPcmWave(input.data.data(), input.data.size()) ? " (PCM)" : " (compressed)") << "\n";
+    }
+    std::cout << "Wrote " << inputs.size() << " samples, " << bank.size() << " bytes to " << argv[1] << "\n";
+    return 0;
+}